@@ -17,6 +17,9 @@ void IERG3810_clocktree_init(void)
 	RCC ->CR   |= 0x01000000;
 	while(!(RCC->CR>>25));
 	RCC ->CFGR   |= 0x00000002;
+#ifdef HOST_BUILD
+	RCC ->CFGR   |= 0x00000008; // SWS = PLL: the switch hardware would report
+#endif
 	while(temp != 0x02)
 	{
 		temp = RCC->CFGR>>2;
@@ -0,0 +1,159 @@
+#include <stdio.h>
+#include "stm32f10x.h"
+#include "IERG3810_USART.h"
+#include "IERG3810_Profile.h"
+#ifdef HOST_BUILD
+#include "host_hal.h"
+#endif
+
+prof_zone_stats prof_table[PROF_MAX_ZONES];
+lat_histogram lat_table[LAT_MAX_ACTIONS];
+
+void prof_init(void)
+{
+#ifndef HOST_BUILD
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk; // DWT needs trace enabled
+    DWT_CYCCNT = 0;
+    DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+#endif
+    prof_reset();
+}
+
+void prof_reset(void)
+{
+    u8 i;
+    for (i = 0; i < PROF_MAX_ZONES; i++) {
+        prof_table[i].count = 0;
+        prof_table[i].min = 0xFFFFFFFF;
+        prof_table[i].max = 0;
+        prof_table[i].total = 0;
+    }
+    for (i = 0; i < LAT_MAX_ACTIONS; i++) {
+        u8 b;
+        lat_table[i].count = 0;
+        lat_table[i].max = 0;
+        for (b = 0; b < LAT_BUCKETS; b++) lat_table[i].bucket[b] = 0;
+    }
+}
+
+#ifdef HOST_BUILD
+// The HAL's virtual clock, so lcd_sim's profile, HUD, latency and trace
+// numbers follow the scripted timeline and repeat run to run
+u32 prof_host_cycles(void)
+{
+    return (u32)(host_now() * PROF_HCLK_MHZ / (HOST_HCLK_HZ / 1000000));
+}
+#endif
+
+// CYCCNT wraps every ~60 s at 72 MHz; unsigned subtraction covers one wrap
+void prof_end(u8 zone, u32 start)
+{
+    u32 cycles = prof_now() - start;
+    prof_zone_stats *z = &prof_table[zone];
+    
+    z->count++;
+    if (cycles < z->min) z->min = cycles;
+    if (cycles > z->max) z->max = cycles;
+    z->total += cycles;
+}
+
+// Dumps in progress. prof_poll sends them a line at a time, the zone table
+// before the histograms, as the USART2 ring has room; each row is read when
+// it is formatted.
+static const char *const *zone_names;
+static u8 zone_count, zone_step, zone_busy = 0;
+static const char *const *lat_names;
+static u8 lat_count, lat_step, lat_busy = 0;
+static char dump_line[120];
+static u32 dump_len = 0;            // formatted but not yet queued
+
+// Line step of the zone table, 0 past the last one
+static u32 prof_format(u8 step)
+{
+    prof_zone_stats *z;
+    
+    if (step == 0) return sprintf(dump_line, "zone              count      min      avg      max  total_ms\r\n");
+    step--;
+    if (step >= zone_count || step >= PROF_MAX_ZONES) return 0;
+    z = &prof_table[step];
+    if (z->count == 0) {
+        return sprintf(dump_line, "%-16s      0        -        -        -         0\r\n", zone_names[step]);
+    }
+    return sprintf(dump_line, "%-16s %6u %8u %8u %8u %9u\r\n", zone_names[step],
+                   (unsigned)z->count, (unsigned)z->min, (unsigned)(z->total / z->count),
+                   (unsigned)z->max, (unsigned)(z->total / (PROF_HCLK_MHZ * 1000)));
+}
+
+void prof_dump(const char *const *names, u8 count)
+{
+    if (zone_busy) return;
+    zone_names = names;
+    zone_count = count;
+    zone_step = 0;
+    zone_busy = 1;
+}
+
+void lat_record(u8 action, u32 start)
+{
+    u32 cycles = prof_now() - start;
+    u32 ms = cycles / (PROF_HCLK_MHZ * 1000);
+    lat_histogram *h = &lat_table[action];
+    u8 b = 0;
+    
+    while (b < LAT_BUCKETS - 1 && ms >= (1u << b)) b++;
+    h->bucket[b]++;
+    h->count++;
+    if (cycles > h->max) h->max = cycles;
+}
+
+// Line step of the latency histograms, 0 past the last one
+static u32 lat_format(u8 step)
+{
+    lat_histogram *h;
+    int len;
+    u8 b;
+    
+    if (step == 0) {
+        len = sprintf(dump_line, "latency ms        count    max |");
+        for (b = 0; b < LAT_BUCKETS - 1; b++) len += sprintf(dump_line + len, " <%-4u", 1u << b);
+        return len + sprintf(dump_line + len, " more\r\n");
+    }
+    step--;
+    if (step >= lat_count || step >= LAT_MAX_ACTIONS) return 0;
+    h = &lat_table[step];
+    len = sprintf(dump_line, "%-16s %6u %6u |", lat_names[step], (unsigned)h->count,
+                  (unsigned)(h->max / (PROF_HCLK_MHZ * 1000)));
+    for (b = 0; b < LAT_BUCKETS; b++) len += sprintf(dump_line + len, " %5u", (unsigned)h->bucket[b]);
+    return len + sprintf(dump_line + len, "\r\n");
+}
+
+void lat_dump(const char *const *names, u8 count)
+{
+    if (lat_busy) return;
+    lat_names = names;
+    lat_count = count;
+    lat_step = 0;
+    lat_busy = 1;
+}
+
+// Call once per main-loop pass. Queues whole lines while they fit and returns
+// 1 while either dump still has lines to send.
+u8 prof_poll(void)
+{
+    while (zone_busy || lat_busy) {
+        if (dump_len == 0) {
+            if (zone_busy) {
+                dump_len = prof_format(zone_step++);
+                if (dump_len == 0) zone_busy = 0;
+            } else {
+                dump_len = lat_format(lat_step++);
+                if (dump_len == 0) lat_busy = 0;
+            }
+            if (dump_len == 0) continue;
+        }
+        if (IERG3810_usart2_tx_free() < dump_len) break;
+        IERG3810_usart2_write(dump_line, dump_len);
+        dump_len = 0;
+    }
+    return zone_busy || lat_busy;
+}
@@ -0,0 +1,65 @@
+#ifndef __IERG3810_PROFILE_H
+#define __IERG3810_PROFILE_H
+#include "stm32f10x.h"
+
+// Cycle-count profiling zones. The caller numbers its zones 0..PROF_MAX_ZONES-1
+// and brackets code with PROF_BEGIN(z) / PROF_END(z) inside one block. The
+// start stamp lives on the caller's stack, so zones may nest and an IRQ zone
+// can interrupt any other.
+#define PROF_ENABLE     1
+#define PROF_MAX_ZONES  8
+#define PROF_HCLK_MHZ   72      // cycles per microsecond
+
+// CMSIS 1.3 core_cm3.h has no DWT block, so the two registers used are here
+#define DWT_CTRL        (*(volatile u32 *)0xE0001000)
+#define DWT_CYCCNT      (*(volatile u32 *)0xE0001004)
+#define DWT_CTRL_CYCCNTENA  (1 << 0)
+
+typedef struct {
+    u32 count;
+    u32 min;
+    u32 max;
+    unsigned long long total;
+} prof_zone_stats;
+
+extern prof_zone_stats prof_table[PROF_MAX_ZONES];
+
+void prof_init(void);
+void prof_reset(void);
+void prof_end(u8 zone, u32 start);
+void prof_dump(const char *const *names, u8 count);   // table over USART2, sent by prof_poll
+
+// Latency histograms: lat_record(action, start) files the time since start
+// under action. Bucket b counts latencies below 2^b ms, the last bucket
+// everything longer. prof_reset clears these too.
+#define LAT_MAX_ACTIONS 6
+#define LAT_BUCKETS     12
+
+typedef struct {
+    u32 count;
+    u32 max;                    // cycles
+    u32 bucket[LAT_BUCKETS];
+} lat_histogram;
+
+extern lat_histogram lat_table[LAT_MAX_ACTIONS];
+
+void lat_record(u8 action, u32 start);
+void lat_dump(const char *const *names, u8 count);    // histograms over USART2, sent by prof_poll
+u8 prof_poll(void);     // once per main-loop pass; 1 while a dump is still being sent
+
+#ifdef HOST_BUILD
+u32 prof_host_cycles(void);     // Host/host_hal.c virtual time at PROF_HCLK_MHZ
+#define prof_now()      prof_host_cycles()
+#else
+#define prof_now()      DWT_CYCCNT
+#endif
+
+#if PROF_ENABLE
+#define PROF_BEGIN(z)   u32 prof_start_##z = prof_now()
+#define PROF_END(z)     prof_end(z, prof_start_##z)
+#else
+#define PROF_BEGIN(z)
+#define PROF_END(z)
+#endif
+
+#endif
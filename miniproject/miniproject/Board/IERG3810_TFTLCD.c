@@ -1,5 +1,5 @@
 #include "stm32f10x.h"
-#include "IERG3810_CLOCK.h"
+#include "IERG3810_Clock.h"
 #include "IERG3810_TFTLCD.h"
 #include "FONT.H"
 #include "CFONT.H"
@@ -7,25 +7,31 @@
 #define LCD_LIGHT_ON  (GPIOB->BSRR = 1<<0)
 #define LCD_LIGHT_OFF (GPIOB->BRR = 1<<0)
 
+static u8 lcd_madctl = 0xC8; // 0x36 value of the normal orientation
+#if LCD_BUS_STATS
+u32 lcd_bus_writes = 0;
+#endif
 	
 void lcd_9341_setParameter(void) {
+    lcd_madctl = 0xC8;
     lcd_wr_reg(0x01); // Software reset
     lcd_wr_reg(0x11); // Exit sleep
     lcd_wr_reg(0x3A); // Pixel format
     lcd_wr_data(0x55); // 16-bit color
     lcd_wr_reg(0x29); // Display on
     lcd_wr_reg(0x36); // Memory access control
-    lcd_wr_data(0xC8); // Display direction
+    lcd_wr_data(lcd_madctl); // Display direction
 }
 
 void lcd_7789_setParameter(void) {
+    lcd_madctl = 0x80;
     lcd_wr_reg(0x01); // Software reset
     lcd_wr_reg(0x11); // Exit sleep
     lcd_wr_reg(0x3A); // Pixel format
     lcd_wr_data(0x05);
     lcd_wr_reg(0x29); // Display on
     lcd_wr_reg(0x36); // Memory access control
-    lcd_wr_data(0x80); // Display direction
+    lcd_wr_data(lcd_madctl); // Display direction
 }
 
 
@@ -95,64 +101,354 @@ void lcd_init(void) //set FSMC
     
     // Use appropriate initialization based on your LCD model
     lcd_9341_setParameter(); //lcd_7789_setParameter()
+    lcd_window_invalidate();
 		
 		lcd_backlight_init();
 		LCD_LIGHT_ON;
 		
+		lcd_dma_init();
 }
 
 void lcd_wr_reg(u16 regval) 
 {
-    LCD->LCD_REG = regval;
+    lcd_dma_wait(); // a command must not cut into a DMA fill
+    LCD_WR_REG(regval);
 }
 
 void lcd_wr_data(u16 data) 
 {
-    LCD->LCD_RAM = data;
+    LCD_WR_DATA(data);
+}
+
+// ==========================================
+// DMA2 memory-to-memory transfers into LCD_RAM
+// ==========================================
+// The destination is always the fixed LCD_RAM address. The source (the
+// channel's peripheral side) is either one fixed colour word (fills) or an
+// incrementing pixel buffer (strips). CNDTR is 16 bits so big transfers are
+// sent as a chain of chunks, the next one started from the transfer-complete
+// interrupt.
+static volatile u16 lcd_dma_color;      // must outlive the caller's stack frame
+static const volatile u16 *lcd_dma_src; // source of the next chunk
+static u8 lcd_dma_src_inc;              // 1 = buffer, 0 = repeated colour word
+static volatile u32 lcd_dma_remaining;  // items not yet handed to the channel
+static volatile u8 lcd_dma_active = 0;
+static lcd_dma_callback lcd_dma_done = 0;
+
+static void lcd_dma_kick(void) {
+    const volatile u16 *src = lcd_dma_src;
+    u16 chunk = lcd_dma_remaining > LCD_DMA_MAX_CHUNK ? LCD_DMA_MAX_CHUNK : lcd_dma_remaining;
+    lcd_dma_remaining -= chunk;
+    if (lcd_dma_src_inc) lcd_dma_src += chunk;
+    
+    DMA_Cmd(LCD_DMA_CHANNEL, DISABLE);
+    if (lcd_dma_src_inc) LCD_DMA_CHANNEL->CCR |= DMA_CCR1_PINC;
+    else LCD_DMA_CHANNEL->CCR &= ~DMA_CCR1_PINC;
+    LCD_DMA_CHANNEL->CPAR = (u32)(unsigned long)src;
+    DMA_SetCurrDataCounter(LCD_DMA_CHANNEL, chunk);
+    DMA_Cmd(LCD_DMA_CHANNEL, ENABLE);
+#ifdef HOST_BUILD
+    host_dma_run(LCD_DMA_CHANNEL, src, DMA2_Channel1_IRQHandler);
+#endif
+}
+
+void lcd_dma_init(void) {
+    DMA_InitTypeDef dma;
+    
+    RCC->AHBENR |= 1<<1;    //DMA2
+    
+    DMA_DeInit(LCD_DMA_CHANNEL);
+    dma.DMA_PeripheralBaseAddr = (u32)(unsigned long)&lcd_dma_color;
+    dma.DMA_MemoryBaseAddr = LCD_RAM_ADDR;
+    dma.DMA_DIR = DMA_DIR_PeripheralSRC;
+    dma.DMA_BufferSize = 0;
+    dma.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    dma.DMA_MemoryInc = DMA_MemoryInc_Disable;
+    dma.DMA_PeripheralDataSize = DMA_PeripheralDataSize_HalfWord;
+    dma.DMA_MemoryDataSize = DMA_MemoryDataSize_HalfWord;
+    dma.DMA_Mode = DMA_Mode_Normal;
+    dma.DMA_Priority = DMA_Priority_High;
+    dma.DMA_M2M = DMA_M2M_Enable;
+    DMA_Init(LCD_DMA_CHANNEL, &dma);
+    DMA_ITConfig(LCD_DMA_CHANNEL, DMA_IT_TC, ENABLE);
+    
+    // Below the PS/2 EXTI (0x65) so keyboard bits are never held off
+    NVIC->IP[DMA2_Channel1_IRQn] = 0x70;
+    NVIC->ISER[DMA2_Channel1_IRQn >> 5] |= 1 << (DMA2_Channel1_IRQn & 0x1F);
+}
+
+void DMA2_Channel1_IRQHandler(void) {
+    if (DMA_GetITStatus(DMA2_IT_TC1)) {
+        DMA_ClearITPendingBit(DMA2_IT_TC1);
+        if (lcd_dma_remaining > 0) {
+            lcd_dma_kick();
+        } else {
+            lcd_dma_callback done = lcd_dma_done;
+            DMA_Cmd(LCD_DMA_CHANNEL, DISABLE);
+            lcd_dma_done = 0;
+            lcd_dma_active = 0;
+            if (done) done();
+        }
+    }
+}
+
+u8 lcd_dma_busy(void) {
+    return lcd_dma_active;
+}
+
+void lcd_dma_wait(void) {
+    while (lcd_dma_active);
+}
+
+// Streams count copies of color into LCD_RAM. The caller has already opened
+// the window and sent 0x2C. Returns at once; done runs from the DMA interrupt.
+void lcd_dma_fill(u16 color, u32 count, lcd_dma_callback done) {
+    lcd_dma_wait();
+    LCD_BUS_COUNT(count);
+    if (count == 0) {
+        if (done) done();
+        return;
+    }
+    lcd_dma_color = color;
+    lcd_dma_src = &lcd_dma_color;
+    lcd_dma_src_inc = 0;
+    lcd_dma_remaining = count;
+    lcd_dma_done = done;
+    lcd_dma_active = 1;
+    lcd_dma_kick();
+}
+
+// Streams count pixels from a buffer into LCD_RAM. The buffer must stay
+// untouched until done runs (or lcd_dma_busy() drops).
+void lcd_dma_write(const u16 *pixels, u32 count, lcd_dma_callback done) {
+    lcd_dma_wait();
+    LCD_BUS_COUNT(count);
+    if (count == 0) {
+        if (done) done();
+        return;
+    }
+    lcd_dma_src = pixels;
+    lcd_dma_src_inc = 1;
+    lcd_dma_remaining = count;
+    lcd_dma_done = done;
+    lcd_dma_active = 1;
+    lcd_dma_kick();
+}
+
+// ==========================================
+// Ping-pong strip renderer
+// ==========================================
+// The window is produced strip by strip: raster fills one buffer with the
+// CPU while DMA drains the other into LCD_RAM. Strip height is whatever fits
+// LCD_STRIP_PIXELS at this window width.
+static u16 lcd_strip_buf[2][LCD_STRIP_PIXELS];
+
+void lcd_renderStrips(u16 start_x, u16 length_x, u16 start_y, u16 length_y, lcd_strip_raster raster) {
+    u16 strip_rows = LCD_STRIP_PIXELS / length_x;
+    u16 row = 0;
+    u8 cur = 0;
+    
+    if (strip_rows == 0) return; // wider than a strip buffer
+    lcd_setWindow(start_x, length_x, start_y, length_y);
+    while (row < length_y) {
+        u16 rows = length_y - row < strip_rows ? length_y - row : strip_rows;
+        // lcd_strip_buf[cur] was handed to DMA two strips ago; its transfer
+        // finished before the previous strip could start
+        raster(lcd_strip_buf[cur], row, rows);
+#if LCD_DMA_STRIPS
+        lcd_dma_write(lcd_strip_buf[cur], (u32)rows * length_x, 0);
+#else
+        lcd_writePixels(lcd_strip_buf[cur], (u32)rows * length_x);
+#endif
+        cur ^= 1;
+        row += rows;
+    }
+}
+
+// ==========================================
+// Address-window cache
+// ==========================================
+// 0x2C always restarts at the column/page start, so a window that is already
+// set never needs sending again. Each axis is tracked on its own; 0xFFFF
+// marks it unknown (after reset or anything else touching 0x2A/0x2B/0x36).
+static u16 win_xs = 0xFFFF, win_xe = 0xFFFF;
+static u16 win_ys = 0xFFFF, win_ye = 0xFFFF;
+
+#if LCD_WINDOW_STATS
+lcd_window_stats lcd_win_stats;   // running totals since the last lcd_window_frame()
+lcd_window_stats lcd_win_frame;   // totals of the last completed frame
+#define WIN_STAT(field, n)  (lcd_win_stats.field += (n))
+#else
+#define WIN_STAT(field, n)
+#endif
+
+void lcd_window_invalidate(void) {
+    win_xs = win_xe = 0xFFFF;
+    win_ys = win_ye = 0xFFFF;
+}
+
+void lcd_window_frame(void) {
+#if LCD_WINDOW_STATS
+    lcd_win_frame = lcd_win_stats;
+    lcd_win_stats.cmds_sent = 0;
+    lcd_win_stats.params_sent = 0;
+    lcd_win_stats.cmds_saved = 0;
+    lcd_win_stats.params_saved = 0;
+#endif
+}
+
+static void lcd_setColumns(u16 xs, u16 xe) {
+    if (xs == win_xs && xe == win_xe) {
+        WIN_STAT(cmds_saved, 1);
+        WIN_STAT(params_saved, 4);
+        return;
+    }
+    lcd_wr_reg(0x2A);
+    lcd_wr_data(xs >> 8);
+    lcd_wr_data(xs & 0xFF);
+    lcd_wr_data(xe >> 8);
+    lcd_wr_data(xe & 0xFF);
+    win_xs = xs;
+    win_xe = xe;
+    WIN_STAT(cmds_sent, 1);
+    WIN_STAT(params_sent, 4);
+}
+
+static void lcd_setPages(u16 ys, u16 ye) {
+    if (ys == win_ys && ye == win_ye) {
+        WIN_STAT(cmds_saved, 1);
+        WIN_STAT(params_saved, 4);
+        return;
+    }
+    lcd_wr_reg(0x2B);
+    lcd_wr_data(ys >> 8);
+    lcd_wr_data(ys & 0xFF);
+    lcd_wr_data(ye >> 8);
+    lcd_wr_data(ye & 0xFF);
+    win_ys = ys;
+    win_ye = ye;
+    WIN_STAT(cmds_sent, 1);
+    WIN_STAT(params_sent, 4);
 }
 
 void lcd_drawDot(u16 x, u16 y, u16 color) {
-    lcd_wr_reg(0x2A); // set x position
-    lcd_wr_data(x>>8);
-    lcd_wr_data(x & 0xFF);
-    lcd_wr_data(0x01);
-    lcd_wr_data(0x3F);
-    
-    lcd_wr_reg(0x2B); // set y position
-    lcd_wr_data(y>>8);
-    lcd_wr_data(y & 0xFF);
-    lcd_wr_data(0x01);
-    lcd_wr_data(0xDF);
+    lcd_setColumns(x, 0x013F); // set x position
+    lcd_setPages(y, 0x01DF);   // set y position
     
     lcd_wr_reg(0x2C); // write color
     lcd_wr_data(color);
 }
 
-void lcd_fillRectangle(u16 color, u16 start_x, u16 length_x, u16 start_y, u16 length_y) {
-    u32 index = 0;
-    
+// Opens a write window and sends 0x2C; pixels then stream left to right,
+// bottom row first, until the window is full.
+void lcd_setWindow(u16 start_x, u16 length_x, u16 start_y, u16 length_y) {
     // Set column address
-    lcd_wr_reg(0x2A);
-    lcd_wr_data(start_x >> 8);
-    lcd_wr_data(start_x & 0xFF);
-    lcd_wr_data((start_x + length_x - 1) >> 8);
-    lcd_wr_data((start_x + length_x - 1) & 0xFF);
+    lcd_setColumns(start_x, start_x + length_x - 1);
     
     // Set page address  
-    lcd_wr_reg(0x2B);
-    lcd_wr_data(start_y >> 8);
-    lcd_wr_data(start_y & 0xFF);
-    lcd_wr_data((start_y + length_y - 1) >> 8);
-    lcd_wr_data((start_y + length_y - 1) & 0xFF);
+    lcd_setPages(start_y, start_y + length_y - 1);
     
     // Write to memory
     lcd_wr_reg(0x2C);
+}
+
+void lcd_fillRectangle(u16 color, u16 start_x, u16 length_x, u16 start_y, u16 length_y) {
+    lcd_fillRectangle_async(color, start_x, length_x, start_y, length_y, 0);
+}
 
+// Large fills go to DMA and return while the transfer is still running; the
+// next LCD command waits for it. done (may be 0) runs once the last pixel is out.
+void lcd_fillRectangle_async(u16 color, u16 start_x, u16 length_x, u16 start_y, u16 length_y, lcd_dma_callback done) {
+    u32 index = 0;
+    u32 count = (u32)length_x * length_y;
+    
+    lcd_setWindow(start_x, length_x, start_y, length_y);
+    
+#if LCD_DMA_FILL
+    if (count >= LCD_DMA_MIN_PIXELS) {
+        lcd_dma_fill(color, count, done);
+        return;
+    }
+#endif
     
     // Fill the rectangle
-    for (index = 0; index < length_x * length_y; index++) {
+    for (index = 0; index < count; index++) {
         lcd_wr_data(color);
     }
+    if (done) done();
+}
+
+// Continues the current write window (see lcd_setWindow) with count pixels.
+void lcd_writePixels(const u16 *pixels, u32 count) {
+    while (count--) {
+        LCD_WR_DATA(*pixels++);
+    }
+}
+
+// Streams a length_x * length_y RGB565 image (row-major, bottom row first)
+// through a single window.
+void lcd_drawImage(const u16 *pixels, u16 start_x, u16 length_x, u16 start_y, u16 length_y) {
+    u32 index;
+    u32 count = (u32)length_x * length_y;
+    
+    lcd_setWindow(start_x, length_x, start_y, length_y);
+    for (index = 0; index < count; index++) {
+        LCD_WR_DATA(pixels[index]);
+    }
+}
+
+// As lcd_drawImage, but the outer frame pixels of the image are replaced by
+// frame_color on the way out, so a highlight costs no extra window or overdraw.
+void lcd_drawImageFramed(const u16 *pixels, u16 start_x, u16 length_x, u16 start_y, u16 length_y, u8 frame, u16 frame_color) {
+    u16 row, col;
+    
+    lcd_setWindow(start_x, length_x, start_y, length_y);
+    for (row = 0; row < length_y; row++) {
+        if (row < frame || row >= length_y - frame) {
+            for (col = 0; col < length_x; col++) LCD_WR_DATA(frame_color);
+        } else {
+            for (col = 0; col < frame; col++) LCD_WR_DATA(frame_color);
+            for (; col < length_x - frame; col++) LCD_WR_DATA(pixels[col]);
+            for (; col < length_x; col++) LCD_WR_DATA(frame_color);
+        }
+        pixels += length_x;
+    }
+}
+
+// Palettised image: bpp (1, 2, 4 or 8) bits per pixel, LSB-first within a
+// byte, each row padded to a whole byte. Indices are expanded through palette
+// while streaming, one window for the whole image.
+void lcd_drawIndexed(const u8 *bits, u8 bpp, const u16 *palette, u16 start_x, u16 length_x, u16 start_y, u16 length_y) {
+    lcd_drawIndexedFramed(bits, bpp, palette, start_x, length_x, start_y, length_y, 0, 0);
+}
+
+void lcd_drawIndexedFramed(const u8 *bits, u8 bpp, const u16 *palette, u16 start_x, u16 length_x, u16 start_y, u16 length_y, u8 frame, u16 frame_color) {
+    u16 row, col;
+    u16 stride = ((u32)length_x * bpp + 7) >> 3;
+    u8 mask = (1 << bpp) - 1;
+    u8 first_shift = (frame * bpp) & 7;
+    const u8 *first = bits + ((frame * bpp) >> 3);
+    
+    lcd_setWindow(start_x, length_x, start_y, length_y);
+    for (row = 0; row < length_y; row++) {
+        if (row < frame || row >= length_y - frame) {
+            for (col = 0; col < length_x; col++) LCD_WR_DATA(frame_color);
+        } else {
+            const u8 *p = first;
+            u8 shift = first_shift;
+            for (col = 0; col < frame; col++) LCD_WR_DATA(frame_color);
+            for (; col < length_x - frame; col++) {
+                LCD_WR_DATA(palette[(*p >> shift) & mask]);
+                shift += bpp;
+                if (shift == 8) {
+                    shift = 0;
+                    p++;
+                }
+            }
+            for (; col < length_x; col++) LCD_WR_DATA(frame_color);
+        }
+        first += stride;
+    }
 }
 
 void lcd_sevenSegment(u16 color, u16 start_x, u16 start_y, u8 digit) {
@@ -177,16 +473,76 @@ void lcd_sevenSegment(u16 color, u16 start_x, u16 start_y, u8 digit) {
     if (pattern & 0x40) lcd_fillRectangle(color, start_x+10, 60, start_y+70, 10);
 }
 
+// asc2_1608 keeps each glyph column as two bytes: [2c] holds rows 8-15 and
+// [2c+1] rows 0-7, LSB at the bottom. Merged, bit r of the word is row r.
+#define GLYPH_COLUMN(g, c)  ((u16)((g)[2*(c)+1] | ((g)[2*(c)] << 8)))
+
+#if LCD_TEXT_EXCHANGE
+// Row/column exchange (MADCTL MV): 0x2A now addresses y and 0x2B x, and
+// pixels run up each column before moving right, which is the order
+// asc2_1608 stores glyphs in. The column/page registers keep their raw values
+// across the switch, so the window cache stays valid.
+static void lcd_openColumnWindow(u16 start_x, u16 length_x, u16 start_y, u16 length_y) {
+    lcd_wr_reg(0x36);
+    lcd_wr_data(lcd_madctl | 0x20);
+    lcd_setColumns(start_y, start_y + length_y - 1);
+    lcd_setPages(start_x, start_x + length_x - 1);
+    lcd_wr_reg(0x2C);
+}
+
+static void lcd_closeColumnWindow(void) {
+    lcd_wr_reg(0x36);
+    lcd_wr_data(lcd_madctl);
+}
+
+// 8 columns of 16 pixels; [2c+1] (rows 0-7) goes out before [2c] (rows 8-15)
+static void lcd_streamGlyph(const u8 *glyph, u16 color, u16 bgcolor) {
+    u8 i, b, bits;
+    for (i = 0; i < 16; i++) {
+        bits = glyph[i ^ 1];
+        for (b = 0; b < 8; b++) {
+            LCD_WR_DATA(bits & 1 ? color : bgcolor);
+            bits >>= 1;
+        }
+    }
+}
+#endif
+
+// Opaque glyph: one 8x16 window, 128 streamed pixels. Passing bgcolor equal
+// to color keeps the old transparent dot-by-dot drawing.
 void lcd_showChar(u16 x, u16 y, u8 ascii, u16 color, u16 bgcolor) {
 	u8 i, b, temp1, temp2;
 	u16 tempX, tempY;
-	if	(ascii<32 || ascii >127) return;
+	const u8 *glyph;
+#if !LCD_TEXT_EXCHANGE
+	u16 cols[8];
+#endif
+	if	(ascii<32 || ascii >126) return;
 	ascii -= 32;
+	glyph = asc2_1608[ascii];
+	
+	if (bgcolor != color) {
+#if LCD_TEXT_EXCHANGE
+		lcd_openColumnWindow(x, 8, y, 16);
+		lcd_streamGlyph(glyph, color, bgcolor);
+		lcd_closeColumnWindow();
+#else
+		for (i = 0; i < 8; i++) cols[i] = GLYPH_COLUMN(glyph, i);
+		lcd_setWindow(x, 8, y, 16);
+		for (b = 0; b < 16; b++) {
+			for (i = 0; i < 8; i++) {
+				LCD_WR_DATA((cols[i] >> b) & 1 ? color : bgcolor);
+			}
+		}
+#endif
+		return;
+	}
+	
 	tempX = x;
 	
 	for (i = 0; i < 16; i = i + 2) {
-        temp1 = asc2_1608[ascii][i];      // Upper byte of column
-        temp2 = asc2_1608[ascii][i + 1];  // Lower byte of column
+        temp1 = glyph[i];      // Upper byte of column
+        temp2 = glyph[i + 1];  // Lower byte of column
         tempY = y;
         
         // Process each bit in the bytes
@@ -207,13 +563,75 @@ void lcd_showChar(u16 x, u16 y, u8 ascii, u16 color, u16 bgcolor) {
     }
 }
 
+// Opaque strings go out as one (8*len)x16 window: glyph after glyph in
+// exchange mode, or row by row across all glyphs in the normal orientation.
 void lcd_showString(u16 x, u16 y, const char* s, u16 color, u16 bgcolor) {
-    while (*s) {//while string exist
-		char ch = *s++;//read current character then pos +1
-		if ((u8)ch < 32 || (u8)ch > 127) ch = ' ';//restrict the passed char to be matching the char in font.h
-		lcd_showChar(x, y, (u8)ch, color, bgcolor);//print char
-		x += 8; // advance by character width of 8
-	}
+#if !LCD_TEXT_EXCHANGE
+    static u16 cols[LCD_WIDTH]; // glyph columns of the whole string: 480 bytes, static rather than on the 1 KB (Stack_Size) stack
+    u8 b, c;
+#endif
+    u16 len = 0, max_len, i;
+    u8 ch;
+    
+    if (bgcolor == color) {
+        while (*s) {//while string exist
+            char ch = *s++;//read current character then pos +1
+            if ((u8)ch < 32 || (u8)ch > 126) ch = ' ';//restrict the passed char to be matching the char in font.h
+            lcd_showChar(x, y, (u8)ch, color, bgcolor);//print char
+            x += 8; // advance by character width of 8
+        }
+        return;
+    }
+    
+    if (x >= LCD_WIDTH) return;
+    max_len = (LCD_WIDTH - x) / 8; // clip at the right edge instead of wrapping
+    while (s[len] && len < max_len) len++;
+    if (len == 0) return;
+    
+#if LCD_TEXT_EXCHANGE
+    lcd_openColumnWindow(x, len * 8, y, 16);
+    for (i = 0; i < len; i++) {
+        ch = (u8)s[i];
+        if (ch < 32 || ch > 126) ch = ' ';
+        lcd_streamGlyph(asc2_1608[ch - 32], color, bgcolor);
+    }
+    lcd_closeColumnWindow();
+#else
+    for (i = 0; i < len; i++) {
+        ch = (u8)s[i];
+        if (ch < 32 || ch > 126) ch = ' ';
+        for (c = 0; c < 8; c++) cols[i * 8 + c] = GLYPH_COLUMN(asc2_1608[ch - 32], c);
+    }
+    
+    lcd_setWindow(x, len * 8, y, 16);
+    for (b = 0; b < 16; b++) {
+        for (i = 0; i < len * 8; i++) {
+            LCD_WR_DATA((cols[i] >> b) & 1 ? color : bgcolor);
+        }
+    }
+#endif
+}
+
+// Software counterpart of lcd_showString for line buffers: writes glyph row
+// `row` (0 = bottom) of s, placed at screen column x, into line, which covers
+// screen columns line_x .. line_x + line_w - 1. Clips like lcd_showString.
+void lcd_textRow(u16 *line, u16 line_x, u16 line_w, u16 x, u8 row, const char *s, u16 color, u16 bgcolor) {
+    u16 px;
+    u8 c, ch;
+    
+    for (; *s && x + 8 <= LCD_WIDTH; s++, x += 8) {
+        if (x >= line_x + line_w) break;
+        ch = (u8)*s;
+        if (ch < 32 || ch > 126) ch = ' ';
+        for (c = 0; c < 8; c++) {
+            px = x + c;
+            if (px < line_x || px >= line_x + line_w) continue;
+            if ((GLYPH_COLUMN(asc2_1608[ch - 32], c) >> row) & 1)
+                line[px - line_x] = color;
+            else if (bgcolor != color)
+                line[px - line_x] = bgcolor;
+        }
+    }
 }
 
 void lcd_showChinChar(u16 x, u16 y, u8 index, u16 color, u16 bgcolor) {
@@ -247,11 +665,57 @@ void lcd_showChinChar(u16 x, u16 y, u8 index, u16 color, u16 bgcolor) {
     }
 }
 
+// Integer-scaled opaque glyph for the column-major 16-row fonts (asc2_1608,
+// and chi_1616 as read by lcd_showChinScaled): one window per glyph, each
+// source row expanded once into a line buffer and streamed scale times.
+void lcd_drawGlyphScaled(const u8 *glyph, u8 columns, u16 x, u16 y, u8 scale, u16 color, u16 bgcolor) {
+    u16 line[16 * LCD_MAX_SCALE];
+    u16 width, px;
+    u8 r, c, k;
+    u16 *p;
+    
+    if (scale < 1) scale = 1;
+    if (scale > LCD_MAX_SCALE) scale = LCD_MAX_SCALE;
+    width = columns * scale;
+    if (x + width > LCD_WIDTH || y + 16 * scale > LCD_HEIGHT) return;
+    
+    lcd_setWindow(x, width, y, 16 * scale);
+    for (r = 0; r < 16; r++) {
+        p = line;
+        for (c = 0; c < columns; c++) {
+            px = (GLYPH_COLUMN(glyph, c) >> r) & 1 ? color : bgcolor;
+            for (k = 0; k < scale; k++) *p++ = px;
+        }
+        for (k = 0; k < scale; k++) lcd_writePixels(line, width);
+    }
+}
+
+void lcd_showCharScaled(u16 x, u16 y, u8 ascii, u8 scale, u16 color, u16 bgcolor) {
+    if (ascii < 32 || ascii > 126) return;
+    lcd_drawGlyphScaled(asc2_1608[ascii - 32], 8, x, y, scale, color, bgcolor);
+}
+
+void lcd_showStringScaled(u16 x, u16 y, const char* s, u8 scale, u16 color, u16 bgcolor) {
+    while (*s) {
+        u8 ch = (u8)*s++;
+        if (ch < 32 || ch > 126) ch = ' ';
+        lcd_showCharScaled(x, y, ch, scale, color, bgcolor);
+        x += 8 * scale;
+    }
+}
+
+// Opaque (bgcolor != color) goes through lcd_drawGlyphScaled; equal colours
+// keep the transparent dot-by-dot drawing.
 void lcd_showChinScaled(u16 x, u16 y, u8 index, u16 color, u16 bgcolor) {
     int scale=2;//for scaling if want to show larger character
 		int col, bit1, bit2, dx1, dy1, dx2, dy2;
 	
     if (index >= (sizeof(chi_1616)/sizeof(chi_1616[0]))) return;
+    
+    if (bgcolor != color) {
+        lcd_drawGlyphScaled(chi_1616[index], 16, x, y, scale, color, bgcolor);
+        return;
+    }
 
     for (col = 0; col < 16; col++) {//16 columns for chin char
         u8 upper = chi_1616[index][col*scale + 0];
@@ -13,6 +13,10 @@
 #define c_BLUE      0x001F
 #define c_YELLOW    0xFFE0
 
+// Panel size in the 0xC8 orientation set by lcd_9341_setParameter
+#define LCD_WIDTH   240
+#define LCD_HEIGHT  320
+
 // LCD structure
 typedef struct {
     u16 LCD_REG;
@@ -21,20 +25,104 @@ typedef struct {
 
 #define LCD_BASE    ((u32)(0x6C000000 | 0x000007FE))
 #define LCD         ((LCD_TypeDef *) LCD_BASE)
+#define LCD_RAM_ADDR (LCD_BASE + 2)   // &LCD->LCD_RAM as a bus address (DMA target)
+
+// FSMC write counter for the performance HUD: every CPU write plus every
+// item handed to DMA (0 = compile the counting out)
+#define LCD_BUS_STATS   1
+
+#if LCD_BUS_STATS
+extern u32 lcd_bus_writes;
+#define LCD_BUS_COUNT(n)    (lcd_bus_writes += (n))
+#else
+#define LCD_BUS_COUNT(n)    ((void)0)
+#endif
+
+// Raw bus writes; the Linux build sends them to the emulated panel instead
+#ifdef HOST_BUILD
+#include "host_lcd.h"
+#define LCD_WR_REG(v)   (LCD_BUS_COUNT(1), host_lcd_wr_reg(v))
+#define LCD_WR_DATA(v)  (LCD_BUS_COUNT(1), host_lcd_wr_data(v))
+#else
+#define LCD_WR_REG(v)   (LCD_BUS_COUNT(1), LCD->LCD_REG = (v))
+#define LCD_WR_DATA(v)  (LCD_BUS_COUNT(1), LCD->LCD_RAM = (v))
+#endif
+
+// DMA2 fill settings
+#define LCD_DMA_FILL        1               // 0 = always fill with the CPU loop
+#define LCD_DMA_CHANNEL     DMA2_Channel1
+#define LCD_DMA_MIN_PIXELS  256             // below this the CPU loop is cheaper than the setup
+#define LCD_DMA_MAX_CHUNK   65535           // CNDTR is 16 bits
+
+typedef void (*lcd_dma_callback)(void);
+
+// Strip renderer: two buffers of LCD_STRIP_PIXELS (2 x 4.8 KB SRAM)
+#define LCD_DMA_STRIPS      1                   // 0 = strips are written by the CPU
+#define LCD_STRIP_PIXELS    (LCD_WIDTH * 10)
+
+// Fills buf with rows [first_row, first_row + rows) of the window, row-major
+typedef void (*lcd_strip_raster)(u16 *buf, u16 first_row, u16 rows);
+
+// 1 = opaque text streams glyph columns natively with MADCTL row/column
+// exchange; 0 = rows in the normal orientation. The exchange saves the
+// column unpacking but costs 4 more bus writes per window (143 vs 139 for a
+// glyph, lcd_bench), so rows are the default. The host build overrides it
+// for lcd_bench_exchange and lcd_golden_exchange.
+#ifndef LCD_TEXT_EXCHANGE
+#define LCD_TEXT_EXCHANGE   0
+#endif
+
+// Largest factor accepted by lcd_drawGlyphScaled
+#define LCD_MAX_SCALE       4
+
+// Address-window cache counters (0 = compile the counting out)
+#define LCD_WINDOW_STATS    1
+
+typedef struct {
+    u32 cmds_sent;      // 0x2A/0x2B commands actually written
+    u32 params_sent;    // their parameter bytes
+    u32 cmds_saved;     // 0x2A/0x2B skipped because the axis was already set
+    u32 params_saved;   // parameter bytes skipped with them
+} lcd_window_stats;
+
+#if LCD_WINDOW_STATS
+extern lcd_window_stats lcd_win_stats;
+extern lcd_window_stats lcd_win_frame;
+#endif
 
 // Function declarations
 void lcd_init(void);
 void lcd_wr_reg(u16 regval);
 void lcd_wr_data(u16 data);
 void lcd_drawDot(u16 x, u16 y, u16 color);
+void lcd_window_invalidate(void);
+void lcd_window_frame(void);
+void lcd_setWindow(u16 start_x, u16 length_x, u16 start_y, u16 length_y);
 void lcd_fillRectangle(u16 color, u16 start_x, u16 length_x, u16 start_y, u16 length_y);
+void lcd_fillRectangle_async(u16 color, u16 start_x, u16 length_x, u16 start_y, u16 length_y, lcd_dma_callback done);
+void lcd_writePixels(const u16 *pixels, u32 count);
+void lcd_drawImage(const u16 *pixels, u16 start_x, u16 length_x, u16 start_y, u16 length_y);
+void lcd_drawImageFramed(const u16 *pixels, u16 start_x, u16 length_x, u16 start_y, u16 length_y, u8 frame, u16 frame_color);
+void lcd_drawIndexed(const u8 *bits, u8 bpp, const u16 *palette, u16 start_x, u16 length_x, u16 start_y, u16 length_y);
+void lcd_drawIndexedFramed(const u8 *bits, u8 bpp, const u16 *palette, u16 start_x, u16 length_x, u16 start_y, u16 length_y, u8 frame, u16 frame_color);
+void lcd_dma_init(void);
+void lcd_dma_fill(u16 color, u32 count, lcd_dma_callback done);
+void lcd_dma_write(const u16 *pixels, u32 count, lcd_dma_callback done);
+void lcd_renderStrips(u16 start_x, u16 length_x, u16 start_y, u16 length_y, lcd_strip_raster raster);
+u8 lcd_dma_busy(void);
+void lcd_dma_wait(void);
+void DMA2_Channel1_IRQHandler(void);
 void lcd_showChar(u16 x, u16 y, u8 ascii, u16 color, u16 bgcolor);
 void lcd_backlight_init(void);
 void lcd_sevenSegment(u16 color, u16 start_x, u16 start_y, u8 digit);
 void lcd_showChar(u16 x, u16 y, u8 ascii, u16 color, u16 bgcolor);
 void lcd_showString(u16 x, u16 y, const char* s, u16 color, u16 bgcolor);
+void lcd_textRow(u16 *line, u16 line_x, u16 line_w, u16 x, u8 row, const char *s, u16 color, u16 bgcolor);
 void lcd_showChinChar(u16 x, u16 y, u8 index, u16 color, u16 bgcolor);
 void lcd_showChinString(u16 x, u16 y, int index,char* s, u16 color, u16 bgcolor);
 void lcd_showChinScaled(u16 x, u16 y, u8 index, u16 color, u16 bgcolor);
+void lcd_drawGlyphScaled(const u8 *glyph, u8 columns, u16 x, u16 y, u8 scale, u16 color, u16 bgcolor);
+void lcd_showCharScaled(u16 x, u16 y, u8 ascii, u8 scale, u16 color, u16 bgcolor);
+void lcd_showStringScaled(u16 x, u16 y, const char* s, u8 scale, u16 color, u16 bgcolor);
 
 #endif
@@ -0,0 +1,103 @@
+#include <stdio.h>
+#include "stm32f10x.h"
+#include "IERG3810_USART.h"
+#include "IERG3810_Trace.h"
+
+static trace_event trace_ring[TRACE_EVENTS];
+static u16 trace_head = 0;          // next slot to fill
+static u16 trace_count = 0;         // valid events, up to TRACE_EVENTS
+static volatile u8 trace_on = 0;    // off while dumping so the dump is one snapshot
+
+void trace_init(void)
+{
+    trace_head = 0;
+    trace_count = 0;
+    trace_on = 1;
+}
+
+void trace_record(u8 phase, u8 id, u16 arg)
+{
+    trace_event *e;
+#ifndef HOST_BUILD
+    u32 primask = __get_PRIMASK();
+    __disable_irq();    // main loop and ISRs share the ring
+#endif
+    if (trace_on) {
+        e = &trace_ring[trace_head];
+        e->cycles = prof_now();
+        e->arg = arg;
+        e->id = id;
+        e->phase = phase | ((SCB->ICSR & 0x1FF) ? 0x80 : 0); // VECTACTIVE
+        trace_head = (trace_head + 1) & (TRACE_EVENTS - 1);
+        if (trace_count < TRACE_EVENTS) trace_count++;
+    }
+#ifndef HOST_BUILD
+    __set_PRIMASK(primask);
+#endif
+}
+
+// A dump in progress: trace_poll sends it a line at a time, as much as the
+// USART2 ring has room for, so asking for one never stalls the main loop
+static const char *const *dump_names;
+static u8 dump_name_count;
+static u16 dump_step;               // next line to format
+static u16 dump_first;              // ring index of the oldest event
+static u8 dump_busy = 0;
+static char dump_line[48];
+static u32 dump_len = 0;            // formatted but not yet queued
+
+// Text format, one record per line:
+//   TRACE <events> <cycles per us>
+//   N <id> <name>
+//   <cycles hex> <B|E|I> <in isr 0/1> <id> <arg>
+//   END
+// Returns 0 past the last line.
+static u32 trace_format(u16 step)
+{
+    if (step == 0) return sprintf(dump_line, "TRACE %u %u\r\n", (unsigned)trace_count, PROF_HCLK_MHZ);
+    step--;
+    if (step < dump_name_count) return sprintf(dump_line, "N %u %s\r\n", step, dump_names[step]);
+    step -= dump_name_count;
+    if (step < trace_count) {
+        trace_event *e = &trace_ring[(dump_first + step) & (TRACE_EVENTS - 1)];
+        return sprintf(dump_line, "%08X %c %u %u %u\r\n", (unsigned)e->cycles,
+                       e->phase & 0x7F, (e->phase >> 7) & 1, e->id, e->arg);
+    }
+    if (step == trace_count) return sprintf(dump_line, "END\r\n");
+    return 0;
+}
+
+// Starts a dump of the ring as it is now; trace_poll sends it. Recording
+// stays off until the last line is queued, so the dump is one snapshot; a
+// second request while one is running is ignored.
+void trace_dump(const char *const *names, u8 count)
+{
+    if (dump_busy) return;
+    trace_on = 0;
+    dump_names = names;
+    dump_name_count = count;
+    dump_first = (trace_head - trace_count) & (TRACE_EVENTS - 1);
+    dump_step = 0;
+    dump_len = 0;
+    dump_busy = 1;
+}
+
+// Call once per main-loop pass. Queues whole lines while they fit and returns
+// 1 while the dump still has lines to send.
+u8 trace_poll(void)
+{
+    while (dump_busy) {
+        if (dump_len == 0) {
+            dump_len = trace_format(dump_step++);
+            if (dump_len == 0) {
+                dump_busy = 0;
+                trace_on = 1;
+                break;
+            }
+        }
+        if (IERG3810_usart2_tx_free() < dump_len) break;
+        IERG3810_usart2_write(dump_line, dump_len);
+        dump_len = 0;
+    }
+    return dump_busy;
+}
@@ -0,0 +1,42 @@
+#ifndef __IERG3810_TRACE_H
+#define __IERG3810_TRACE_H
+#include "stm32f10x.h"
+#include "IERG3810_Profile.h"
+
+// RAM ring of timestamped begin / end / instant events. The caller numbers
+// its event ids and passes their names to trace_dump, which prints the ring
+// (oldest first) over USART2. Host/trace2chrome turns that text into Chrome
+// trace-event JSON. Recording is safe from interrupt handlers; events logged
+// inside one are marked so the viewer puts them on their own track.
+// The dump goes out over several main-loop passes: trace_poll sends what fits
+// in the USART2 ring each time and recording resumes once it is done.
+#define TRACE_ENABLE    1
+#define TRACE_EVENTS    1024            // 8 bytes each
+
+#define TRACE_BEGIN     'B'
+#define TRACE_END       'E'
+#define TRACE_INSTANT   'I'
+
+typedef struct {
+    u32 cycles;         // prof_now()
+    u16 arg;
+    u8 id;
+    u8 phase;           // TRACE_BEGIN / _END / _INSTANT, bit 7 = in an ISR
+} trace_event;
+
+void trace_init(void);
+void trace_record(u8 phase, u8 id, u16 arg);
+void trace_dump(const char *const *names, u8 count);   // starts a dump
+u8 trace_poll(void);    // 1 while a dump is still being sent
+
+#if TRACE_ENABLE
+#define TRACE_B(id, arg)    trace_record(TRACE_BEGIN, id, arg)
+#define TRACE_E(id, arg)    trace_record(TRACE_END, id, arg)
+#define TRACE_I(id, arg)    trace_record(TRACE_INSTANT, id, arg)
+#else
+#define TRACE_B(id, arg)
+#define TRACE_E(id, arg)
+#define TRACE_I(id, arg)
+#endif
+
+#endif
@@ -1,6 +1,10 @@
 #include "stm32f10x.h"
 #include "IERG3810_Clock.h"
 #include "IERG3810_USART.h"
+#include <stdio.h>
+#ifdef HOST_BUILD
+#include "host_lcd.h"
+#endif
 
 void IERG3810_usart2_init(u32 pclkl, u32 baud)
 {
@@ -52,3 +56,127 @@ void IERG3810_usart1_init(u32 pclk2, u32 baud)
 	
 }
 
+// ==========================================
+// USART2 TX ring drained by DMA1 channel 7
+// ==========================================
+// The main loop only moves head, the DMA interrupt only moves tail. A
+// transfer covers the contiguous bytes from tail up to head (or the end of
+// the buffer); its completion advances tail and starts the next one.
+static volatile char usart2_tx_ring[USART2_TX_RING_SIZE];
+static volatile u16 usart2_tx_head = 0;    // next free byte
+static volatile u16 usart2_tx_tail = 0;    // oldest byte not yet sent
+static volatile u16 usart2_tx_inflight = 0; // bytes in the running transfer, 0 = idle
+static u8 usart2_tx_ready = 0;
+usart2_tx_stats usart2_tx;
+
+static void usart2_tx_kick(void)
+{
+	u16 head = usart2_tx_head;
+	u16 tail = usart2_tx_tail;
+	u16 len;
+	
+	if (head == tail) return;
+	len = head > tail ? head - tail : USART2_TX_RING_SIZE - tail;
+	usart2_tx_inflight = len;
+	usart2_tx.bytes_sent += len;
+	
+	DMA_Cmd(USART2_TX_DMA, DISABLE);
+	USART2_TX_DMA->CMAR = (u32)(unsigned long)&usart2_tx_ring[tail];
+	DMA_SetCurrDataCounter(USART2_TX_DMA, len);
+	DMA_Cmd(USART2_TX_DMA, ENABLE);
+#ifdef HOST_BUILD
+	host_dma_run(USART2_TX_DMA, &usart2_tx_ring[tail], DMA1_Channel7_IRQHandler);
+#endif
+}
+
+void IERG3810_usart2_dma_init(u32 pclk1, u32 baud)
+{
+	DMA_InitTypeDef dma;
+	
+	IERG3810_usart2_init(pclk1, baud);
+	
+	RCC->AHBENR |= 1<<0;    //DMA1
+	DMA_DeInit(USART2_TX_DMA);
+	dma.DMA_PeripheralBaseAddr = (u32)(unsigned long)&USART2->DR;
+	dma.DMA_MemoryBaseAddr = (u32)(unsigned long)usart2_tx_ring;
+	dma.DMA_DIR = DMA_DIR_PeripheralDST;
+	dma.DMA_BufferSize = 0;
+	dma.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+	dma.DMA_MemoryInc = DMA_MemoryInc_Enable;
+	dma.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+	dma.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+	dma.DMA_Mode = DMA_Mode_Normal;
+	dma.DMA_Priority = DMA_Priority_Low;
+	dma.DMA_M2M = DMA_M2M_Disable;
+	DMA_Init(USART2_TX_DMA, &dma);
+	DMA_ITConfig(USART2_TX_DMA, DMA_IT_TC, ENABLE);
+	USART_DMACmd(USART2, USART_DMAReq_Tx, ENABLE);
+	
+	// Lowest of the project's interrupts: telemetry can always wait
+	NVIC->IP[DMA1_Channel7_IRQn] = 0x90;
+	NVIC->ISER[DMA1_Channel7_IRQn >> 5] |= 1 << (DMA1_Channel7_IRQn & 0x1F);
+	usart2_tx_ready = 1;
+}
+
+void DMA1_Channel7_IRQHandler(void)
+{
+	if (DMA_GetITStatus(DMA1_IT_TC7)) {
+		DMA_ClearITPendingBit(DMA1_IT_TC7);
+		DMA_Cmd(USART2_TX_DMA, DISABLE);
+		usart2_tx_tail = (usart2_tx_tail + usart2_tx_inflight) & (USART2_TX_RING_SIZE - 1);
+		usart2_tx_inflight = 0;
+		usart2_tx_kick();
+	}
+}
+
+// Queues what fits and starts the DMA if it is idle. While a transfer is
+// running only its interrupt starts the next one, so there is no race on
+// the channel.
+u32 IERG3810_usart2_write(const char *buf, u32 len)
+{
+	u16 head = usart2_tx_head;
+	u16 free = (usart2_tx_tail - head - 1) & (USART2_TX_RING_SIZE - 1);
+	u32 n = len < free ? len : free;
+	u32 i;
+	
+	if (!usart2_tx_ready) n = 0; // before IERG3810_usart2_dma_init: drop
+	for (i = 0; i < n; i++) {
+		usart2_tx_ring[head] = buf[i];
+		head = (head + 1) & (USART2_TX_RING_SIZE - 1);
+	}
+	usart2_tx_head = head;
+	if (n < len) {
+		usart2_tx.bytes_dropped += len - n;
+		usart2_tx.writes_dropped++;
+	}
+	if (n && usart2_tx_inflight == 0) usart2_tx_kick();
+	return n;
+}
+
+// Bytes IERG3810_usart2_write would accept right now
+u32 IERG3810_usart2_tx_free(void)
+{
+	return (usart2_tx_tail - usart2_tx_head - 1) & (USART2_TX_RING_SIZE - 1);
+}
+
+void IERG3810_usart2_send(const char *s)
+{
+	u32 len = 0;
+	while (s[len]) len++;
+	IERG3810_usart2_write(s, len);
+}
+
+// printf() goes to the ring as well. The Linux build keeps libc's stdout.
+#ifndef HOST_BUILD
+#pragma import(__use_no_semihosting)
+struct __FILE { int handle; };
+FILE __stdout;
+void _sys_exit(int x) { x = x; }
+
+int fputc(int ch, FILE *f)
+{
+	char c = ch;
+	IERG3810_usart2_write(&c, 1);
+	return ch;
+}
+#endif
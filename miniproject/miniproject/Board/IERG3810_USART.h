@@ -6,5 +6,27 @@
 void IERG3810_usart1_init(u32 pclk2, u32 baud);
 void IERG3810_usart2_init(u32 pclkl, u32 baud);
 
+// USART2 telemetry: bytes go into a RAM ring that DMA1 channel 7 drains in
+// the background. Writers never wait; when the ring is full the rest of the
+// message is dropped and counted. Single producer: call from the main loop
+// only, never from an interrupt handler.
+#define USART2_BAUD         115200      // main() passes this to IERG3810_usart2_dma_init
+#define USART2_TX_RING_SIZE 1024        // power of two
+#define USART2_TX_DMA       DMA1_Channel7
+
+typedef struct {
+    u32 bytes_sent;         // handed to DMA
+    u32 bytes_dropped;      // did not fit in the ring
+    u32 writes_dropped;     // messages cut short by a full ring
+} usart2_tx_stats;
+
+extern usart2_tx_stats usart2_tx;
+
+void IERG3810_usart2_dma_init(u32 pclk1, u32 baud);
+u32 IERG3810_usart2_write(const char *buf, u32 len);   // returns bytes queued
+u32 IERG3810_usart2_tx_free(void);
+void IERG3810_usart2_send(const char *s);
+void DMA1_Channel7_IRQHandler(void);
+
 
 #endif
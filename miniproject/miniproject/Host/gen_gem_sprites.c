@@ -0,0 +1,154 @@
+// Build-time generator for User/GEMSPRITE.H.
+//   gcc -o gen_gem_sprites Host/gen_gem_sprites.c && ./gen_gem_sprites > User/GEMSPRITE.H
+// Rasterises every (colour, type) board tile into 4-bpp palette indices so
+// the firmware only has to blit them (see GEM_PALETTE in User/project.c).
+#include <stdio.h>
+
+typedef unsigned char u8;
+
+#define TILE_SIZE   20
+#define NUM_COLORS  6
+#define BPP         4
+
+#define NORMAL_TILE 0
+#define HORIZONTAL_CLEARER 1
+#define VERTICAL_CLEARER 2
+#define BOMB 3
+
+// Palette slots; GEM_PALETTE in project.c is laid out in this order
+#define PAL_GRID_BG 0
+#define PAL_BORDER  1
+#define PAL_WHITE   2
+#define PAL_RED     3
+#define PAL_GEM0    3   // GEM_COLORS[0] is RED, gems 0..5 use slots 3..8
+
+static u8 *raster_target;
+
+// lcd_fillRectangle into the sprite being built (tile-local coordinates)
+static void raster_fill(u8 color, int x, int w, int y, int h) {
+    for (int row = y; row < y + h; row++) {
+        if (row < 0 || row >= TILE_SIZE) continue;
+        for (int col = x; col < x + w; col++) {
+            if (col >= 0 && col < TILE_SIZE) raster_target[row * TILE_SIZE + col] = color;
+        }
+    }
+}
+
+// Tile Background + Jewel at (0,0); same drawing order as the old layered renderer
+static void raster_jewel_tile(u8 *buf, int color_index, int type) {
+    int x_pos = 0, y_pos = 0;
+    raster_target = buf;
+    
+    // 1. Draw Cell Background (The Frame)
+    raster_fill(PAL_GRID_BG, x_pos, TILE_SIZE, y_pos, TILE_SIZE);
+    
+    // 2. Draw Cell Border
+    raster_fill(PAL_BORDER, x_pos, TILE_SIZE, y_pos, 1); // Bottom
+    raster_fill(PAL_BORDER, x_pos, TILE_SIZE, y_pos + TILE_SIZE - 1, 1); // Top
+    raster_fill(PAL_BORDER, x_pos, 1, y_pos, TILE_SIZE); // Left
+    raster_fill(PAL_BORDER, x_pos + TILE_SIZE - 1, 1, y_pos, TILE_SIZE); // Right
+    
+    // If empty, just return (we drew the empty cell bg)
+    if (color_index == -1) return;
+
+    // Center coordinates for shapes
+    int cx = x_pos + 10;
+    int cy = y_pos + 10;
+    u8 color = PAL_GEM0 + color_index;
+    int i, width, start_x;
+    
+    // 3. Draw Geometric Shape (Slightly smaller to fit in frame)
+    switch(color_index) {
+        case 0: // RED -> SQUARE
+            raster_fill(color, x_pos + 5, 10, y_pos + 5, 10);
+            break;
+            
+        case 1: // GREEN -> CIRCLE
+            raster_fill(color, x_pos + 7, 6, y_pos + 4, 1);
+            raster_fill(color, x_pos + 5, 10, y_pos + 5, 1);
+            raster_fill(color, x_pos + 4, 12, y_pos + 6, 8); 
+            raster_fill(color, x_pos + 5, 10, y_pos + 14, 1);
+            raster_fill(color, x_pos + 7, 6, y_pos + 15, 1);
+            break;
+            
+        case 2: // BLUE -> DIAMOND
+            for (i = 0; i < 6; i++) {
+                width = 2 * i + 1; 
+                start_x = cx - i;
+                raster_fill(color, start_x, width, cy + (5 - i), 1);
+                raster_fill(color, start_x, width, cy - (5 - i), 1);
+            }
+            raster_fill(color, x_pos + 4, 13, cy, 1);
+            break;
+            
+        case 3: // YELLOW -> PENTAGON
+             // Top Triangle
+            for (i = 0; i < 5; i++) {
+                width = 2 * i + 2; 
+                start_x = cx - (width / 2);
+                raster_fill(color, start_x, width, cy - 5 + i, 1);
+            }
+            // Base
+            for (i = 0; i < 6; i++) {
+                width = 10 - i; 
+                start_x = cx - (width / 2);
+                raster_fill(color, start_x, width, cy + i, 1);
+            }
+            break;
+            
+        case 4: // ORANGE -> TRIANGLE (Down)
+            for (i = 0; i < 11; i++) {
+                width = 11 - i; 
+                raster_fill(color, cx - (width/2), width, y_pos + 5 + i, 1);
+            }
+            break;
+            
+        case 5: // MAGENTA -> PLUS
+            raster_fill(color, x_pos + 8, 4, y_pos + 3, 14); // Vertical
+            raster_fill(color, x_pos + 3, 14, y_pos + 8, 4); // Horizontal
+            break;
+    }
+    
+    // 4. Special Markers
+    if (type == HORIZONTAL_CLEARER) {
+        raster_fill(PAL_WHITE, x_pos + 3, 14, cy - 1, 2);
+    } else if (type == VERTICAL_CLEARER) {
+        raster_fill(PAL_WHITE, cx - 1, 2, y_pos + 3, 14);
+    } else if (type == BOMB) {
+        raster_fill(PAL_WHITE, cx - 3, 6, cy - 3, 6);
+        raster_fill(PAL_RED, cx, 1, cy, 1);
+    }
+}
+
+
+int main(void) {
+    u8 pix[TILE_SIZE * TILE_SIZE];
+    int idx, c, t, i;
+    int count = 1 + NUM_COLORS * 4;
+    int bytes = TILE_SIZE * TILE_SIZE * BPP / 8;
+
+    printf("#ifndef __GEMSPRITE_H\n#define __GEMSPRITE_H\n\n");
+    printf("// Generated by Host/gen_gem_sprites.c - do not edit.\n");
+    printf("// %dx%d board tiles, %d-bpp indices into GEM_PALETTE, two pixels per byte\n", TILE_SIZE, TILE_SIZE, BPP);
+    printf("// (left pixel in the low nibble), rows bottom first. Entry 0 is the empty\n");
+    printf("// cell, entry 1 + colour * 4 + type the gems.\n\n");
+    printf("#define GEM_SPRITE_BPP   %d\n", BPP);
+    printf("#define GEM_SPRITE_COUNT %d\n", count);
+    printf("#define GEM_SPRITE_BYTES %d\n\n", bytes);
+    printf("#define PAL_GRID_BG %d\n#define PAL_BORDER  %d\n#define PAL_WHITE   %d\n#define PAL_RED     %d\n#define PAL_GEM0    %d\n\n",
+           PAL_GRID_BG, PAL_BORDER, PAL_WHITE, PAL_RED, PAL_GEM0);
+    printf("const unsigned char gem_sprites[GEM_SPRITE_COUNT][GEM_SPRITE_BYTES]={\n");
+    for (idx = 0; idx < count; idx++) {
+        c = idx == 0 ? -1 : (idx - 1) / 4;
+        t = idx == 0 ? NORMAL_TILE : (idx - 1) % 4;
+        raster_jewel_tile(pix, c, t);
+        printf("{");
+        for (i = 0; i < TILE_SIZE * TILE_SIZE; i += 2) {
+            printf("0x%02X%s", pix[i] | (pix[i + 1] << 4), i + 2 < TILE_SIZE * TILE_SIZE ? "," : "");
+            if ((i + 2) % 40 == 0 && i + 2 < TILE_SIZE * TILE_SIZE) printf("\n ");
+        }
+        printf("}%s/* colour %d, type %d */\n", idx + 1 < count ? "," : "", c, t);
+    }
+    printf("};\n\n#endif\n");
+    return 0;
+}
@@ -0,0 +1,53 @@
+#ifndef __HOST_GAME_H
+#define __HOST_GAME_H
+#include "stm32f10x.h"
+#include "GAMESTATE.H"
+
+// What the Linux tools reach into User/project.c for. project.c has no
+// header of its own; these must match its definitions.
+#define HOST_GRID_SIZE  9
+#define HOST_NUM_COLORS 6
+
+// PS/2 scan codes handled by handle_keyboard_input
+#define HOST_KEY_NUM2   0x72
+#define HOST_KEY_NUM4   0x6B
+#define HOST_KEY_NUM5   0x73
+#define HOST_KEY_NUM6   0x74
+#define HOST_KEY_NUM8   0x75
+
+// Board cells as packed by project.c: bits 2..0 = colour + 1, bits 4..3 = type
+#define HOST_CELL(type, colour) ((u8)(((type) << 3) | ((colour) + 1)))
+#define HOST_CELL_COLOR(cell)   (((cell) & 0x07) - 1)
+#define HOST_CELL_EMPTY         0
+
+extern u8 grid[HOST_GRID_SIZE][HOST_GRID_SIZE];     // [y][x]
+extern GameState current_state;
+extern int score;
+extern int cursor_x, cursor_y, is_selected;
+extern int game_timer_seconds;
+extern int key_debounce;
+extern volatile u32 ps2key;
+extern volatile u32 ps2_dropped;
+extern const char *const ZONE_NAMES[];
+#define ZONE_COUNT      6       // profiling zones in project.c
+
+void draw_start_screen(void);
+void draw_instructions_screen(void);
+void draw_gameover_screen(void);
+void draw_frame(void);
+void draw_grid_stable(void);
+void draw_ui_bar(void);
+void draw_single_tile(int x, int y);
+void init_grid_no_matches(void);
+void swap_tiles(int x1, int y1, int x2, int y2);
+int find_and_clear_matches(void);
+void event_begin(void);
+void resolve_cascade(void);
+void play_events(int animate);
+extern int event_count;
+void handle_keyboard_input(void);
+void SysTick_Handler(void);
+void EXTI15_10_IRQHandler(void);
+int project_main(void);     // main() of project.c, renamed by the Makefile
+
+#endif
@@ -0,0 +1,274 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "stm32f10x.h"
+#include "IERG3810_TFTLCD.h"
+#include "host_lcd.h"
+#include "host_game.h"
+#include "host_hal.h"
+
+#define MS(ms)          ((unsigned long long)(ms) * (HOST_HCLK_HZ / 1000))
+#define MAX_STEPS       4096
+#define MAX_PS2_BYTES   8
+
+typedef enum {
+    STEP_KEY1,
+    STEP_KEYUP,
+    STEP_PS2,
+    STEP_PPM,
+    STEP_EXPECT,
+    STEP_PRINT,
+    STEP_QUIT
+} StepKind;
+
+typedef struct {
+    unsigned long long at;      // virtual cycles
+    StepKind kind;
+    u8 ps2[MAX_PS2_BYTES];
+    u8 ps2_len;
+    char what[16];              // EXPECT: state / timer / score / dropped
+    int value;                  // EXPECT: wanted value
+    char path[128];             // PPM
+    int line;
+} Step;
+
+static const char *const state_names[] = {"MENU", "INSTRUCTIONS", "GAME", "GAMEOVER"};
+
+unsigned long long host_time = 0;
+static unsigned long long tick_next = 0;    // 0 = SysTick not running
+static unsigned long long key1_release = 0, keyup_release = 0;
+static Step steps[MAX_STEPS];
+static int n_steps = 0, next_step = 0;
+static int failures = 0;
+static u32 last_bus_writes = 0;
+static int in_advance = 0;
+
+void host_hal_init(void)
+{
+    RCC->CR |= (1 << 17) | (1 << 25);       // HSERDY, PLLRDY
+    GPIOE->IDR |= GPIO_Pin_3;               // KEY1 up
+    GPIOA->IDR |= GPIO_Pin_0;               // KEY_UP up (main() treats 0 as pressed)
+    GPIOC->IDR |= 1 << 10;                  // PS/2 data idles high
+}
+
+int host_hal_failures(void)
+{
+    return failures;
+}
+
+static int parse_state(const char *s)
+{
+    for (int i = 0; i < 4; i++) {
+        if (!strcmp(s, state_names[i])) return i;
+    }
+    return -1;
+}
+
+int host_hal_load(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    char line[256];
+    int lineno = 0;
+    
+    if (!f) {
+        fprintf(stderr, "lcd_sim: cannot read %s\n", path);
+        return -1;
+    }
+    while (fgets(line, sizeof(line), f)) {
+        char cmd[16], a[128], b[32];
+        double ms;
+        int n;
+        Step *st = &steps[n_steps];
+        
+        lineno++;
+        if (line[0] == '#' || sscanf(line, "%lf %15s%n", &ms, cmd, &n) < 2) continue;
+        if (n_steps == MAX_STEPS) {
+            fprintf(stderr, "%s:%d: more than %d steps\n", path, lineno, MAX_STEPS);
+            fclose(f);
+            return -1;
+        }
+        memset(st, 0, sizeof(*st));
+        st->at = (unsigned long long)(ms * (HOST_HCLK_HZ / 1000));
+        st->line = lineno;
+        if (n_steps && st->at < steps[n_steps - 1].at) {
+            fprintf(stderr, "%s:%d: steps must be in time order\n", path, lineno);
+            fclose(f);
+            return -1;
+        }
+        
+        if (!strcmp(cmd, "key1")) {
+            st->kind = STEP_KEY1;
+        } else if (!strcmp(cmd, "keyup")) {
+            st->kind = STEP_KEYUP;
+        } else if (!strcmp(cmd, "ps2")) {
+            char *p = line + n;
+            unsigned v;
+            int used;
+            st->kind = STEP_PS2;
+            while (st->ps2_len < MAX_PS2_BYTES && sscanf(p, "%x%n", &v, &used) == 1) {
+                st->ps2[st->ps2_len++] = v;
+                p += used;
+            }
+        } else if (!strcmp(cmd, "ppm") && sscanf(line + n, "%127s", a) == 1) {
+            st->kind = STEP_PPM;
+            strcpy(st->path, a);
+        } else if (!strcmp(cmd, "expect") && sscanf(line + n, "%15s %31s", st->what, b) == 2) {
+            st->kind = STEP_EXPECT;
+            st->value = strcmp(st->what, "state") ? atoi(b) : parse_state(b);
+        } else if (!strcmp(cmd, "print")) {
+            st->kind = STEP_PRINT;
+        } else if (!strcmp(cmd, "quit")) {
+            st->kind = STEP_QUIT;
+        } else {
+            fprintf(stderr, "%s:%d: bad step: %s", path, lineno, line);
+            fclose(f);
+            return -1;
+        }
+        n_steps++;
+    }
+    fclose(f);
+    return n_steps;
+}
+
+// One PS/2 frame as the keyboard clocks it: start, 8 data bits LSB first,
+// odd parity, stop. Each falling clock edge is one EXTI11 interrupt.
+static void ps2_send(u8 code)
+{
+    u32 bits[11];
+    int ones = 0;
+    
+    bits[0] = 0;
+    for (int i = 0; i < 8; i++) {
+        bits[1 + i] = (code >> i) & 1;
+        ones += bits[1 + i];
+    }
+    bits[9] = !(ones & 1);
+    bits[10] = 1;
+    for (int i = 0; i < 11; i++) {
+        if (bits[i]) GPIOC->IDR |= 1 << 10;
+        else GPIOC->IDR &= ~(1 << 10);
+        EXTI->PR |= 1 << 11;
+        EXTI15_10_IRQHandler();
+        EXTI->PR &= ~(1 << 11);     // rc_w1 on the chip; RAM keeps what was written
+    }
+    GPIOC->IDR |= 1 << 10;
+}
+
+static void print_status(const char *tag)
+{
+    printf("%s t=%.3fs state=%s timer=%d score=%d\n", tag, (double)host_time / HOST_HCLK_HZ,
+           state_names[current_state & 3], game_timer_seconds, score);
+}
+
+static void run_step(const Step *st)
+{
+    switch (st->kind) {
+    case STEP_KEY1:
+        GPIOE->IDR &= ~GPIO_Pin_3;
+        key1_release = host_time + MS(HOST_BUTTON_MS);
+        break;
+    case STEP_KEYUP:
+        GPIOA->IDR &= ~GPIO_Pin_0;
+        keyup_release = host_time + MS(HOST_BUTTON_MS);
+        break;
+    case STEP_PS2:
+        for (int i = 0; i < st->ps2_len; i++) ps2_send(st->ps2[i]);
+        break;
+    case STEP_PPM:
+        if (host_lcd_write_ppm(st->path) != 0) {
+            fprintf(stderr, "lcd_sim: cannot write %s\n", st->path);
+            failures++;
+        }
+        break;
+    case STEP_EXPECT: {
+        int got = !strcmp(st->what, "state") ? (int)current_state :
+                  !strcmp(st->what, "timer") ? game_timer_seconds :
+                  !strcmp(st->what, "score") ? score :
+                  !strcmp(st->what, "dropped") ? (int)ps2_dropped : -9999;
+        if (got != st->value) {
+            printf("line %d: expected %s %d, got %d\n", st->line, st->what, st->value, got);
+            print_status("FAIL");
+            failures++;
+        }
+        break;
+    }
+    case STEP_PRINT:
+        print_status("    ");
+        break;
+    case STEP_QUIT:
+        exit(failures ? 1 : 0);
+    }
+}
+
+// Moves the clock forward, firing SysTick, button releases and script steps
+// at their exact times, in that order when they coincide.
+void host_advance(unsigned long long cycles)
+{
+    unsigned long long end = host_time + cycles;
+    
+    if (in_advance) {       // a handler calling Delay(): time is already moving
+        host_time = end;
+        return;
+    }
+    in_advance = 1;
+    for (;;) {
+        unsigned long long next = end;
+        unsigned long long period = 0;
+        u32 ctrl = SysTick->CTRL;
+        
+        if ((ctrl & 3) == 3) {  // ENABLE + TICKINT; CLKSOURCE 0 = HCLK / 8
+            period = (unsigned long long)(SysTick->LOAD + 1) * ((ctrl & 4) ? 1 : 8);
+            if (tick_next == 0) tick_next = host_time + period;
+            if (tick_next < next) next = tick_next;
+        } else {
+            tick_next = 0;
+        }
+        if (key1_release && key1_release < next) next = key1_release;
+        if (keyup_release && keyup_release < next) next = keyup_release;
+        if (next_step < n_steps && steps[next_step].at < next) next = steps[next_step].at;
+        host_time = next;
+        
+        if (tick_next && tick_next == host_time) {
+            tick_next += period;
+            SysTick_Handler();
+        } else if (key1_release && key1_release == host_time) {
+            GPIOE->IDR |= GPIO_Pin_3;
+            key1_release = 0;
+        } else if (keyup_release && keyup_release == host_time) {
+            GPIOA->IDR |= GPIO_Pin_0;
+            keyup_release = 0;
+        } else if (next_step < n_steps && steps[next_step].at == host_time) {
+            run_step(&steps[next_step++]);
+            // script ran out without a quit: stop after its last step
+            if (next_step == n_steps) exit(failures ? 1 : 0);
+        } else {
+            break;          // nothing due: host_time == end
+        }
+    }
+    in_advance = 0;
+}
+
+// HCLK cycles per LCD write at the FSMC timing lcd_init programmed
+static u32 write_cycles(void)
+{
+    u32 t = (FSMC_Bank1->BTCR[6] & (1 << 14)) ? FSMC_Bank1E->BWTR[6] : FSMC_Bank1->BTCR[7];
+    return (t & 0xF) + ((t >> 8) & 0xFF) + 1;
+}
+
+// Delay() burns count loop iterations; the LCD writes the emulator saw since
+// the last call are charged here too. Counted in host_lcd.c, so LCD_BUS_STATS
+// doesn't change time.
+void host_delay(u32 count)
+{
+    u32 bus = host_lcd_bus_writes - last_bus_writes;
+    
+    last_bus_writes = host_lcd_bus_writes;
+    host_advance((unsigned long long)count * HOST_DELAY_CYCLES + (unsigned long long)bus * write_cycles());
+}
+
+// host_time plus the LCD writes the next Delay() will charge: what CYCCNT
+// would read now
+unsigned long long host_now(void)
+{
+    return host_time + (unsigned long long)(host_lcd_bus_writes - last_bus_writes) * write_cycles();
+}
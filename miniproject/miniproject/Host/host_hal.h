@@ -0,0 +1,24 @@
+#ifndef __HOST_HAL_H
+#define __HOST_HAL_H
+#include "stm32f10x.h"
+
+// Virtual-time stand-in for the board around the unmodified main loop.
+// Time only moves in Delay() (HOST_DELAY_CYCLES per count) plus the bus
+// time of every LCD write since the previous Delay(). As it moves, SysTick
+// fires at the rate SysTick->LOAD/CTRL ask for and scripted inputs are
+// applied: the KEY1/KEY_UP lines in GPIOE/GPIOA->IDR and PS/2 frames
+// clocked bit by bit through EXTI15_10_IRQHandler.
+#define HOST_HCLK_HZ        72000000
+#define HOST_DELAY_CYCLES   4       // one Delay() loop iteration on the M3
+#define HOST_BUTTON_MS      100     // how long a scripted button is held
+
+extern unsigned long long host_time;    // virtual HCLK cycles since reset
+
+void host_hal_init(void);                   // oscillators ready, buttons up
+int host_hal_load(const char *path);        // input script, see lcd_sim.c
+void host_delay(u32 count);                 // Delay() body on the host
+void host_advance(unsigned long long cycles);
+unsigned long long host_now(void);          // virtual cycles, prof_now() on the host
+int host_hal_failures(void);
+
+#endif
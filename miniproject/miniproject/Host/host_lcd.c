@@ -0,0 +1,206 @@
+#include <stdio.h>
+#include <string.h>
+#include "stm32f10x.h"
+#include "IERG3810_TFTLCD.h"
+#include "host_lcd.h"
+
+// ILI9341 behind FSMC, as far as the Board driver uses it: 0x2A/0x2B set
+// the window, 0x2C streams RGB565 into it, 0x36 selects the orientation.
+// Everything else is counted and otherwise ignored.
+
+host_lcd_stats host_lcd;
+u32 host_lcd_bus_writes;
+u16 host_lcd_fb[LCD_HEIGHT][LCD_WIDTH];
+u16 host_lcd_writes[LCD_HEIGHT][LCD_WIDTH];
+u16 host_lcd_unchanged[LCD_HEIGHT][LCD_WIDTH];
+
+// Controller state as the ILI9341 sees it
+static u16 lcd_cmd;                 // last command written to LCD_REG
+static u8 lcd_nparam;               // parameters received for it so far
+static u8 lcd_param[4];
+static u8 lcd_madctl;
+static u16 lcd_sc, lcd_ec, lcd_sp, lcd_ep;  // 0x2A / 0x2B ranges
+static u16 lcd_col, lcd_page;       // write pointer inside the window
+static u8 lcd_window_done;          // pointer ran past EC/EP
+
+// MCU column/page -> framebuffer x/y. The framebuffer is laid out in the
+// orientation lcd_9341_setParameter selects (0xC8): MV swaps the two
+// counters, MX/MY flip an axis relative to that orientation.
+static void lcd_plot(u16 col, u16 page, u16 color)
+{
+    u16 x = col, y = page;
+    if (lcd_madctl & 0x20) {
+        x = page;
+        y = col;
+    }
+    if ((lcd_madctl ^ 0xC8) & 0x40) x = LCD_WIDTH - 1 - x;
+    if ((lcd_madctl ^ 0xC8) & 0x80) y = LCD_HEIGHT - 1 - y;
+    if (x < LCD_WIDTH && y < LCD_HEIGHT) {
+        host_lcd_writes[y][x]++;
+        if (host_lcd_fb[y][x] == color) host_lcd_unchanged[y][x]++;
+        host_lcd_fb[y][x] = color;
+        host_lcd.pixels++;
+    } else {
+        host_lcd.clipped++;
+    }
+}
+
+static void lcd_ram_write(u16 data)
+{
+    if (lcd_cmd == 0x2C) {
+        if (lcd_window_done) {
+            host_lcd.overruns++;
+            return;
+        }
+        lcd_plot(lcd_col, lcd_page, data);
+        if (++lcd_col > lcd_ec) {
+            lcd_col = lcd_sc;
+            if (++lcd_page > lcd_ep) lcd_window_done = 1;
+        }
+        return;
+    }
+    
+    if (lcd_nparam < 4) lcd_param[lcd_nparam] = data & 0xFF;
+    lcd_nparam++;
+    if (lcd_cmd == 0x36 && lcd_nparam == 1) {
+        lcd_madctl = lcd_param[0];
+    } else if (lcd_cmd == 0x2A && lcd_nparam == 4) {
+        lcd_sc = (lcd_param[0] << 8) | lcd_param[1];
+        lcd_ec = (lcd_param[2] << 8) | lcd_param[3];
+    } else if (lcd_cmd == 0x2B && lcd_nparam == 4) {
+        lcd_sp = (lcd_param[0] << 8) | lcd_param[1];
+        lcd_ep = (lcd_param[2] << 8) | lcd_param[3];
+    }
+}
+
+void host_lcd_reset(void)
+{
+    memset(host_lcd_fb, 0, sizeof(host_lcd_fb));
+    lcd_cmd = 0;
+    lcd_nparam = 0;
+    lcd_madctl = 0;
+    lcd_sc = lcd_sp = 0;
+    lcd_ec = LCD_WIDTH - 1;
+    lcd_ep = LCD_HEIGHT - 1;
+    lcd_col = lcd_page = 0;
+    lcd_window_done = 0;
+    host_lcd_reset_stats();
+    host_lcd_reset_overdraw();
+}
+
+void host_lcd_reset_overdraw(void)
+{
+    memset(host_lcd_writes, 0, sizeof(host_lcd_writes));
+    memset(host_lcd_unchanged, 0, sizeof(host_lcd_unchanged));
+}
+
+void host_lcd_reset_stats(void)
+{
+    memset(&host_lcd, 0, sizeof(host_lcd));
+}
+
+void host_lcd_wr_reg(u16 regval)
+{
+    host_lcd.reg_writes++;
+    host_lcd_bus_writes++;
+    lcd_cmd = regval & 0xFF;
+    lcd_nparam = 0;
+    switch (lcd_cmd) {
+    case 0x01:                  // software reset
+        lcd_madctl = 0;
+        lcd_sc = lcd_sp = 0;
+        lcd_ec = LCD_WIDTH - 1;
+        lcd_ep = LCD_HEIGHT - 1;
+        break;
+    case 0x2A: host_lcd.caset++; break;
+    case 0x2B: host_lcd.paset++; break;
+    case 0x36: host_lcd.madctl++; break;
+    case 0x2C:                  // RAMWR restarts at the window origin
+        host_lcd.ramwr++;
+        lcd_col = lcd_sc;
+        lcd_page = lcd_sp;
+        lcd_window_done = 0;
+        break;
+    }
+}
+
+void host_lcd_wr_data(u16 data)
+{
+    host_lcd.data_writes++;
+    host_lcd_bus_writes++;
+    lcd_ram_write(data);
+}
+
+// Binary PPM, top of the screen (highest y) first
+int host_lcd_write_ppm(const char *path)
+{
+    FILE *f = fopen(path, "wb");
+    int x, y;
+    
+    if (!f) return -1;
+    fprintf(f, "P6\n%d %d\n255\n", LCD_WIDTH, LCD_HEIGHT);
+    for (y = LCD_HEIGHT - 1; y >= 0; y--) {
+        for (x = 0; x < LCD_WIDTH; x++) {
+            u16 c = host_lcd_fb[y][x];
+            unsigned char rgb[3];
+            rgb[0] = ((c >> 11) & 0x1F) * 255 / 31;
+            rgb[1] = ((c >> 5) & 0x3F) * 255 / 63;
+            rgb[2] = (c & 0x1F) * 255 / 31;
+            fwrite(rgb, 1, 3, f);
+        }
+    }
+    return fclose(f);
+}
+
+void host_dma_run(DMA_Channel_TypeDef *ch, const volatile void *src, void (*irq)(void))
+{
+    DMA_TypeDef *dma;
+    u32 ccr = ch->CCR;
+    u32 dst, flags, n, i;
+    u32 src_inc, src_half;
+
+    if (!(ccr & DMA_CCR1_EN)) return;
+
+    if (ch >= DMA2_Channel1 && ch <= DMA2_Channel5) {
+        dma = DMA2;
+        n = ch - DMA2_Channel1;
+    } else {
+        dma = DMA1;
+        n = ch - DMA1_Channel1;
+    }
+
+    // DIR set: memory is the source, otherwise the peripheral side is
+    if (ccr & DMA_CCR1_DIR) {
+        dst = ch->CPAR;
+        src_inc = ccr & DMA_CCR1_MINC;
+        src_half = (ccr & DMA_CCR1_MSIZE) == DMA_CCR1_MSIZE_0;
+    } else {
+        dst = ch->CMAR;
+        src_inc = ccr & DMA_CCR1_PINC;
+        src_half = (ccr & DMA_CCR1_PSIZE) == DMA_CCR1_PSIZE_0;
+    }
+
+    host_lcd.dma_transfers++;
+    for (i = 0; i < ch->CNDTR; i++) {
+        u16 item;
+        u32 k = src_inc ? i : 0;
+        if (src_half) item = ((const volatile u16 *)src)[k];
+        else item = ((const volatile u8 *)src)[k];
+
+        if (dst == LCD_RAM_ADDR) {
+            host_lcd.dma_items++;
+            host_lcd_bus_writes++;
+            lcd_ram_write(item);
+        } else if (dst == (u32)(unsigned long)&USART2->DR) {
+            host_lcd.usart_bytes++;     // USART2 TX: the terminal is stdout
+            putchar(item);
+        }
+    }
+    ch->CNDTR = 0;
+
+    // Raise GIF + TC, let the handler run, then drop them as IFCR would
+    flags = 0x3u << (4 * n);
+    dma->ISR |= flags;
+    if ((ccr & DMA_CCR1_TCIE) && irq) irq();
+    dma->ISR &= ~flags;
+}
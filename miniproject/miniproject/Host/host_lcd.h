@@ -0,0 +1,40 @@
+#ifndef __HOST_LCD_H
+#define __HOST_LCD_H
+#include "stm32f10x.h"
+
+// Emulated ILI9341 on the FSMC port and the DMA engine for the Linux build.
+// IERG3810_TFTLCD.c routes LCD_REG / LCD_RAM writes here when HOST_BUILD is set.
+typedef struct {
+    u32 reg_writes;     // CPU writes to LCD_REG
+    u32 data_writes;    // CPU writes to LCD_RAM
+    u32 dma_transfers;  // DMA transfers started (one per CNDTR load)
+    u32 dma_items;      // LCD_RAM writes performed by DMA
+    u32 caset;          // 0x2A commands
+    u32 paset;          // 0x2B commands
+    u32 ramwr;          // 0x2C commands
+    u32 madctl;         // 0x36 commands
+    u32 pixels;         // pixels that landed in the framebuffer
+    u32 clipped;        // pixels addressed outside the 240x320 panel
+    u32 overruns;       // pixels written after the window was already full
+    u32 usart_bytes;    // bytes DMA moved into USART2->DR
+} host_lcd_stats;
+
+extern host_lcd_stats host_lcd;
+extern u32 host_lcd_bus_writes;     // every FSMC write, CPU or DMA; never reset
+extern u16 host_lcd_fb[320][240];   // [y][x], y = 0 at the bottom like the game
+extern u16 host_lcd_writes[320][240];       // pixel writes since the last overdraw reset
+extern u16 host_lcd_unchanged[320][240];    // ... of which wrote the value already there
+
+void host_lcd_reset(void);          // blank panel, power-on registers, zero stats
+void host_lcd_reset_stats(void);
+void host_lcd_reset_overdraw(void);
+void host_lcd_wr_reg(u16 regval);
+void host_lcd_wr_data(u16 data);
+int host_lcd_write_ppm(const char *path);
+
+// Runs an enabled channel to completion: CNDTR items from src, then raises
+// TC and calls irq if TCIE is set. CPAR/CMAR only hold 32 bits, so the real
+// source pointer is passed alongside.
+void host_dma_run(DMA_Channel_TypeDef *ch, const volatile void *src, void (*irq)(void));
+
+#endif
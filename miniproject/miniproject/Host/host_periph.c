@@ -0,0 +1,20 @@
+#include "stm32f10x.h"
+
+// RAM-backed peripheral register blocks for the Linux build (see Host/stm32f10x.h)
+GPIO_TypeDef host_GPIO[7];
+AFIO_TypeDef host_AFIO;
+EXTI_TypeDef host_EXTI;
+RCC_TypeDef host_RCC;
+FLASH_TypeDef host_FLASH;
+USART_TypeDef host_USART1;
+USART_TypeDef host_USART2;
+DMA_TypeDef host_DMA1;
+DMA_TypeDef host_DMA2;
+DMA_Channel_TypeDef host_DMA1_Channel[7];
+DMA_Channel_TypeDef host_DMA2_Channel[5];
+FSMC_Bank1_TypeDef host_FSMC_Bank1;
+FSMC_Bank1E_TypeDef host_FSMC_Bank1E;
+SCB_Type host_SCB;
+SysTick_Type host_SysTick;
+NVIC_Type host_NVIC;
+CoreDebug_Type host_CoreDebug;
@@ -0,0 +1,200 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "stm32f10x.h"
+#include "IERG3810_TFTLCD.h"
+#include "host_lcd.h"
+#include "host_game.h"
+
+// FSMC bus-write benchmark for the render paths in User/project.c. Every
+// case starts from the same seeded board, runs once against the emulated
+// panel and reports command/data writes plus the time they take on the bus
+// at the write timings lcd_init programs. Output is JSON on stdout.
+// lcd_bench_exchange is the same program built with LCD_TEXT_EXCHANGE 1, for
+// the per-glyph text cost of the other streaming order.
+//
+//   lcd_bench [-s seed]
+
+#define HCLK_MHZ 72     // IERG3810_clocktree_init: 8 MHz HSE x 9
+
+static unsigned seed = 3810;
+static u32 write_cycles;   // HCLK cycles per FSMC write
+static int cases;
+
+// Mode A write: ADDSET cycles of address setup, DATAST + 1 of data phase.
+// EXTMOD selects BWTR4 for writes, otherwise BTR4 times both directions.
+static u32 fsmc_write_cycles(u32 *addset, u32 *datast)
+{
+    u32 t = (FSMC_Bank1->BTCR[6] & (1 << 14)) ? FSMC_Bank1E->BWTR[6] : FSMC_Bank1->BTCR[7];
+    *addset = t & 0xF;
+    *datast = (t >> 8) & 0xFF;
+    return *addset + *datast + 1;
+}
+
+static int has_match(void)
+{
+    for (int y = 0; y < HOST_GRID_SIZE; y++) {
+        for (int x = 0; x < HOST_GRID_SIZE; x++) {
+            int c = HOST_CELL_COLOR(grid[y][x]);
+            if (c == -1) continue;
+            if (x < HOST_GRID_SIZE - 2 && HOST_CELL_COLOR(grid[y][x+1]) == c &&
+                    HOST_CELL_COLOR(grid[y][x+2]) == c) return 1;
+            if (y < HOST_GRID_SIZE - 2 && HOST_CELL_COLOR(grid[y+1][x]) == c &&
+                    HOST_CELL_COLOR(grid[y+2][x]) == c) return 1;
+        }
+    }
+    return 0;
+}
+
+// Fresh game on the screen: seeded board, cursor in the middle, bar drawn
+static void new_game(void)
+{
+    srand(seed);
+    init_grid_no_matches();
+    key_debounce = 0;
+    draw_frame();
+    draw_grid_stable();
+    lcd_dma_wait();
+}
+
+// First horizontal swap (scanning from the bottom left) that does / does
+// not produce a match
+static int find_swap(int want_match, int *sx, int *sy)
+{
+    for (int y = 0; y < HOST_GRID_SIZE; y++) {
+        for (int x = 0; x < HOST_GRID_SIZE - 1; x++) {
+            int m;
+            swap_tiles(x, y, x + 1, y);
+            m = has_match();
+            swap_tiles(x, y, x + 1, y);
+            if (m == want_match) {
+                *sx = x;
+                *sy = y;
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+// One key press as EXTI15_10_IRQHandler would deliver it. A different code
+// goes in first so the handler's repeat filter never swallows the press.
+static void press(u32 code)
+{
+    ps2key = 0x01;
+    handle_keyboard_input();
+    key_debounce = 0;
+    ps2key = code;
+    handle_keyboard_input();
+    key_debounce = 0;
+}
+
+static u32 bus_writes(void)
+{
+    return host_lcd.reg_writes + host_lcd.data_writes + host_lcd.dma_items;
+}
+
+static void report(const char *name)
+{
+    u32 bus = bus_writes();
+    double us = (double)bus * write_cycles / HCLK_MHZ;
+    
+    printf("%s\n    {\"name\": \"%s\", \"cmd_writes\": %u, \"data_writes\": %u, "
+           "\"dma_writes\": %u, \"bus_writes\": %u, \"est_us\": %.1f",
+           cases++ ? "," : "", name, host_lcd.reg_writes, host_lcd.data_writes,
+           host_lcd.dma_items, bus, us);
+#if LCD_WINDOW_STATS
+    // 0x2A/0x2B the window cache let through and skipped during the case
+    printf(", \"window\": {\"cmds_sent\": %u, \"params_sent\": %u, "
+           "\"cmds_saved\": %u, \"params_saved\": %u}",
+           lcd_win_frame.cmds_sent, lcd_win_frame.params_sent,
+           lcd_win_frame.cmds_saved, lcd_win_frame.params_saved);
+#endif
+    printf("}");
+}
+
+// Opaque text as the HUD and UI bar draw it: one glyph on its own, and a
+// full-width string, whose window setup is shared by all its glyphs
+static void report_text(void)
+{
+    static const char line[] = "F  1234 W 12345 L  123 D  0";
+    u32 glyph, string;
+    
+    host_lcd_reset_stats();
+    lcd_showChar(8, 300, 'A', 0xFFFF, 0x0000);
+    lcd_dma_wait();
+    glyph = bus_writes();
+    host_lcd_reset_stats();
+    lcd_showString(8, 300, line, 0xFFFF, 0x0000);
+    lcd_dma_wait();
+    string = bus_writes();
+    printf("  \"text\": {\"exchange\": %d, \"glyph_bus_writes\": %u, \"string_glyphs\": %u, "
+           "\"string_bus_writes_per_glyph\": %.1f},\n",
+           LCD_TEXT_EXCHANGE, glyph, (unsigned)strlen(line), (double)string / strlen(line));
+}
+
+#define BENCH(name, setup, call) do {   \
+        new_game();                     \
+        setup;                          \
+        host_lcd_reset_stats();         \
+        lcd_window_frame();             \
+        call;                           \
+        lcd_dma_wait();                 \
+        lcd_window_frame();             \
+        report(name);                   \
+    } while (0)
+
+int main(int argc, char **argv)
+{
+    u32 addset, datast;
+    int sx = 0, sy = 0;
+    
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-s") && i + 1 < argc) seed = strtoul(argv[++i], 0, 0);
+        else {
+            fprintf(stderr, "usage: %s [-s seed]\n", argv[0]);
+            return 2;
+        }
+    }
+    
+    host_lcd_reset();
+    lcd_init();
+    write_cycles = fsmc_write_cycles(&addset, &datast);
+    
+    printf("{\n  \"seed\": %u,\n  \"fsmc\": {\"hclk_mhz\": %d, \"addset\": %u, \"datast\": %u, "
+           "\"cycles_per_write\": %u, \"ns_per_write\": %.1f},\n",
+           seed, HCLK_MHZ, addset, datast, write_cycles, write_cycles * 1000.0 / HCLK_MHZ);
+    report_text();
+    printf("  \"benchmarks\": [");
+    
+    BENCH("draw_frame", , draw_frame());
+    BENCH("draw_grid_stable", , draw_grid_stable());
+    BENCH("draw_ui_bar", , draw_ui_bar());
+    BENCH("cursor_move", , press(HOST_KEY_NUM6));
+    
+    // Select the left tile, then press right: swap, clear and cascade (or
+    // swap back), exactly as the keypad does it
+    new_game();
+    if (find_swap(1, &sx, &sy)) {
+        BENCH("swap_match", (cursor_x = sx, cursor_y = sy, is_selected = 1), press(HOST_KEY_NUM6));
+    } else {
+        fprintf(stderr, "lcd_bench: seed %u has no matching swap\n", seed);
+    }
+    new_game();
+    if (find_swap(0, &sx, &sy)) {
+        BENCH("swap_rejected", (cursor_x = sx, cursor_y = sy, is_selected = 1), press(HOST_KEY_NUM6));
+    }
+    
+    // Knock a 3x3 hole out of the middle of the board (no drawing) and let
+    // gravity, refills and any chained matches run to completion, played
+    // frame by frame and then straight to the result
+    BENCH("gravity_cascade",
+          for (int y = 3; y < 6; y++) for (int x = 3; x < 6; x++) grid[y][x] = HOST_CELL_EMPTY,
+          { event_begin(); resolve_cascade(); play_events(1); });
+    BENCH("gravity_cascade_instant",
+          for (int y = 3; y < 6; y++) for (int x = 3; x < 6; x++) grid[y][x] = HOST_CELL_EMPTY,
+          { event_begin(); resolve_cascade(); play_events(0); });
+    
+    printf("\n  ]\n}\n");
+    return 0;
+}
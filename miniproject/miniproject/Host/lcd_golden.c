@@ -0,0 +1,224 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "stm32f10x.h"
+#include "IERG3810_TFTLCD.h"
+#include "host_lcd.h"
+#include "host_game.h"
+
+// Golden-framebuffer check for the renderers. Every tile (colour x type x
+// cursor state) and every screen is drawn on the emulated panel and hashed;
+// "verify" compares against the checked-in golden.txt, "record" rewrites it
+// after an intended visual change. "verify" also checks how fills are split
+// into DMA transfers.
+//
+//   lcd_golden verify [golden.txt]
+//   lcd_golden record [golden.txt]
+
+#define MAX_CASES 128
+#define TILE_X    30    // MARGIN_X: grid cell (0, 0)
+#define TILE_Y    50    // GRID_BASE_Y
+#define TILE      20
+
+typedef struct {
+    char name[40];
+    unsigned long long hash;
+} GoldenCase;
+
+static GoldenCase rendered[MAX_CASES];
+static int n_rendered;
+
+// FNV-1a over the RGB565 words of a screen rectangle
+static unsigned long long fb_hash(int x, int lx, int y, int ly)
+{
+    unsigned long long h = 1469598103934665603ULL;
+    for (int j = y; j < y + ly; j++) {
+        for (int i = x; i < x + lx; i++) {
+            u16 c = host_lcd_fb[j][i];
+            h = (h ^ (c & 0xFF)) * 1099511628211ULL;
+            h = (h ^ (c >> 8)) * 1099511628211ULL;
+        }
+    }
+    return h;
+}
+
+static void add_case(const char *name, unsigned long long hash)
+{
+    if (n_rendered == MAX_CASES) {
+        fprintf(stderr, "lcd_golden: more than %d cases\n", MAX_CASES);
+        exit(2);
+    }
+    snprintf(rendered[n_rendered].name, sizeof(rendered[0].name), "%s", name);
+    rendered[n_rendered].hash = hash;
+    n_rendered++;
+}
+
+static void render_tiles(void)
+{
+    static const char *cursor_names[] = {"plain", "cursor", "selected"};
+    char name[40];
+    
+    for (int colour = -1; colour < HOST_NUM_COLORS; colour++) {
+        for (int type = 0; type < (colour < 0 ? 1 : 4); type++) {
+            for (int cur = 0; cur < 3; cur++) {
+                // Magenta underneath so pixels the tile fails to cover show up
+                lcd_fillRectangle(0xF81F, TILE_X, TILE, TILE_Y, TILE);
+                grid[0][0] = HOST_CELL(type, colour);
+                cursor_x = cur ? 0 : 4;
+                cursor_y = cur ? 0 : 4;
+                is_selected = (cur == 2);
+                draw_single_tile(0, 0);
+                lcd_dma_wait();
+                snprintf(name, sizeof(name), "tile_c%d_t%d_%s", colour, type, cursor_names[cur]);
+                add_case(name, fb_hash(TILE_X, TILE, TILE_Y, TILE));
+            }
+        }
+    }
+}
+
+static void render_screens(void)
+{
+    draw_start_screen();
+    lcd_dma_wait();
+    add_case("screen_start", fb_hash(0, LCD_WIDTH, 0, LCD_HEIGHT));
+    
+    draw_instructions_screen();
+    lcd_dma_wait();
+    add_case("screen_instructions", fb_hash(0, LCD_WIDTH, 0, LCD_HEIGHT));
+    
+    srand(3810);
+    init_grid_no_matches();
+    draw_frame();
+    draw_grid_stable();
+    lcd_dma_wait();
+    add_case("screen_game", fb_hash(0, LCD_WIDTH, 0, LCD_HEIGHT));
+    
+    score = 1234;
+    game_timer_seconds = 75;
+    is_selected = 1;
+    draw_single_tile(cursor_x, cursor_y);
+    draw_ui_bar();
+    lcd_dma_wait();
+    add_case("screen_game_selected", fb_hash(0, LCD_WIDTH, 0, LCD_HEIGHT));
+    
+    draw_gameover_screen();
+    lcd_dma_wait();
+    add_case("screen_gameover", fb_hash(0, LCD_WIDTH, 0, LCD_HEIGHT));
+}
+
+// One fill through lcd_fillRectangle: the DMA transfers it took, and whether
+// every pixel of the rectangle ended up in colour
+static int check_fill(const char *name, u16 color, u16 x, u16 lx, u16 y, u16 ly, u32 transfers)
+{
+    int wrong = 0;
+    
+    lcd_fillRectangle(color ^ 0xFFFF, x, lx, y, ly);
+    lcd_dma_wait();
+    host_lcd_reset_stats();
+    lcd_fillRectangle(color, x, lx, y, ly);
+    lcd_dma_wait();
+    for (int j = y; j < y + ly; j++) {
+        for (int i = x; i < x + lx; i++) {
+            if (host_lcd_fb[j][i] != color) wrong++;
+        }
+    }
+    if (host_lcd.dma_transfers != transfers || wrong) {
+        printf("FAIL    %s: %u DMA transfers (want %u), %d wrong pixels\n", name,
+               (unsigned)host_lcd.dma_transfers, (unsigned)transfers, wrong);
+        return 1;
+    }
+    return 0;
+}
+
+// The whole panel is more than one CNDTR load: the first chunk's completion
+// interrupt chains the rest. Small fills stay on the CPU.
+static int check_dma_chunks(void)
+{
+    int failed = 0;
+    u32 full = (u32)LCD_WIDTH * LCD_HEIGHT;
+    
+#if LCD_DMA_FILL
+    failed += check_fill("dma_full_screen", 0x1234, 0, LCD_WIDTH, 0, LCD_HEIGHT,
+                         (full + LCD_DMA_MAX_CHUNK - 1) / LCD_DMA_MAX_CHUNK);  // 2
+#else
+    failed += check_fill("dma_full_screen", 0x1234, 0, LCD_WIDTH, 0, LCD_HEIGHT, 0);
+#endif
+    failed += check_fill("dma_below_min", 0x4321, 10, 15, 10, (LCD_DMA_MIN_PIXELS - 1) / 15, 0);
+    printf("%d/2 DMA fill checks pass\n", 2 - failed);
+    return failed ? 1 : 0;
+}
+
+static int record(const char *path)
+{
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "lcd_golden: cannot write %s\n", path);
+        return 2;
+    }
+    fprintf(f, "# lcd_golden record: FNV-1a of the emulated framebuffer per case\n");
+    for (int i = 0; i < n_rendered; i++) {
+        fprintf(f, "%s %016llx\n", rendered[i].name, rendered[i].hash);
+    }
+    fclose(f);
+    printf("recorded %d cases in %s\n", n_rendered, path);
+    return 0;
+}
+
+static int verify(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    char line[128], name[40];
+    unsigned long long hash;
+    int seen[MAX_CASES] = {0};
+    int failed = 0, checked = 0;
+    
+    if (!f) {
+        fprintf(stderr, "lcd_golden: cannot read %s\n", path);
+        return 2;
+    }
+    while (fgets(line, sizeof(line), f)) {
+        int i;
+        if (line[0] == '#' || sscanf(line, "%39s %llx", name, &hash) != 2) continue;
+        for (i = 0; i < n_rendered; i++) {
+            if (!strcmp(rendered[i].name, name)) break;
+        }
+        if (i == n_rendered) {
+            printf("MISSING %s (in %s, not rendered)\n", name, path);
+            failed++;
+            continue;
+        }
+        seen[i] = 1;
+        checked++;
+        if (rendered[i].hash != hash) {
+            printf("FAIL    %s: %016llx, golden %016llx\n", name, rendered[i].hash, hash);
+            failed++;
+        }
+    }
+    fclose(f);
+    for (int i = 0; i < n_rendered; i++) {
+        if (!seen[i]) {
+            printf("NEW     %s %016llx (not in %s)\n", rendered[i].name, rendered[i].hash, path);
+            failed++;
+        }
+    }
+    printf("%d/%d cases match %s\n", checked - failed, n_rendered, path);
+    return failed ? 1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = argc > 2 ? argv[2] : "golden.txt";
+    
+    if (argc < 2 || (strcmp(argv[1], "verify") && strcmp(argv[1], "record"))) {
+        fprintf(stderr, "usage: %s verify|record [golden.txt]\n", argv[0]);
+        return 2;
+    }
+    
+    host_lcd_reset();
+    lcd_init();
+    render_tiles();
+    render_screens();
+    
+    if (!strcmp(argv[1], "record")) return record(path);
+    return verify(path) | check_dma_chunks();
+}
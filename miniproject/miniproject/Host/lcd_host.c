@@ -0,0 +1,90 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "stm32f10x.h"
+#include "IERG3810_TFTLCD.h"
+#include "host_lcd.h"
+#include "host_game.h"
+#include "IERG3810_Profile.h"
+#include "IERG3810_USART.h"
+
+// Linux front end for the emulated panel: runs the real renderers from
+// User/project.c against Host/host_lcd.c, prints how many FSMC writes each
+// call cost and dumps every screen as a PPM. The profiling zones are
+// timed with clock_gettime here and printed at the end, through the same
+// USART2 DMA ring as on the board.
+//
+//   lcd_host [-o dir] [-s seed]
+
+static const char *out_dir = ".";
+
+static void report(const char *name)
+{
+    printf("%-26s %7u %8u %8u %5u %5u %5u %8u %6u\n", name,
+           host_lcd.reg_writes, host_lcd.data_writes, host_lcd.dma_items,
+           host_lcd.caset, host_lcd.paset, host_lcd.ramwr,
+           host_lcd.pixels, host_lcd.clipped + host_lcd.overruns);
+}
+
+// Counts one renderer call on its own
+#define MEASURE(call) do {          \
+        host_lcd_reset_stats();     \
+        call;                       \
+        lcd_dma_wait();             \
+        report(#call);              \
+    } while (0)
+
+static void dump(const char *name)
+{
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s.ppm", out_dir, name);
+    if (host_lcd_write_ppm(path) != 0) {
+        fprintf(stderr, "lcd_host: cannot write %s\n", path);
+        exit(1);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    unsigned seed = 3810;
+    int i;
+    
+    for (i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-o") && i + 1 < argc) out_dir = argv[++i];
+        else if (!strcmp(argv[i], "-s") && i + 1 < argc) seed = strtoul(argv[++i], 0, 0);
+        else {
+            fprintf(stderr, "usage: %s [-o dir] [-s seed]\n", argv[0]);
+            return 2;
+        }
+    }
+    
+    host_lcd_reset();
+    lcd_init();
+    prof_init();
+    RCC->CR |= 1 << 17;     // HSERDY, polled by IERG3810_usart2_init
+    IERG3810_usart2_dma_init(36, USART2_BAUD);
+    
+    printf("%-26s %7s %8s %8s %5s %5s %5s %8s %6s\n", "call",
+           "reg", "data", "dma", "2A", "2B", "2C", "pixels", "lost");
+    MEASURE(draw_start_screen());
+    dump("start");
+    MEASURE(draw_instructions_screen());
+    dump("instructions");
+    
+    srand(seed);
+    init_grid_no_matches();
+    MEASURE(draw_frame());
+    MEASURE(draw_grid_stable());
+    dump("game");
+    MEASURE(draw_ui_bar());
+    
+    MEASURE(draw_gameover_screen());
+    dump("gameover");
+    
+    // Same table the keypad '*' sends over USART2 on the board
+    printf("\n");
+    fflush(stdout);
+    prof_dump(ZONE_NAMES, ZONE_COUNT);
+    while (prof_poll());
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "stm32f10x.h"
+#include "IERG3810_TFTLCD.h"
+#include "host_lcd.h"
+#include "host_game.h"
+
+// Overdraw analyzer. Runs each screen in the order the game shows them and
+// counts, per pixel, how often it was written and how many of those writes
+// stored the colour that was already there. Prints the ratios and writes
+// two heatmaps per frame: <name>_writes.ppm and <name>_unchanged.ppm.
+//
+//   lcd_overdraw [-o dir]
+//
+// Heatmap colours: black 0, blue 1, green 2, yellow 3, red 4 or more.
+
+static const char *out_dir = ".";
+
+static const unsigned char heat[5][3] = {
+    {0, 0, 0}, {0, 64, 255}, {0, 200, 0}, {255, 220, 0}, {255, 0, 0}
+};
+
+static void write_heatmap(const char *name, const char *kind, u16 counts[LCD_HEIGHT][LCD_WIDTH])
+{
+    char path[512];
+    FILE *f;
+    
+    snprintf(path, sizeof(path), "%s/%s_%s.ppm", out_dir, name, kind);
+    f = fopen(path, "wb");
+    if (!f) {
+        fprintf(stderr, "lcd_overdraw: cannot write %s\n", path);
+        exit(1);
+    }
+    fprintf(f, "P6\n%d %d\n255\n", LCD_WIDTH, LCD_HEIGHT);
+    for (int y = LCD_HEIGHT - 1; y >= 0; y--) {
+        for (int x = 0; x < LCD_WIDTH; x++) {
+            int n = counts[y][x] > 4 ? 4 : counts[y][x];
+            fwrite(heat[n], 1, 3, f);
+        }
+    }
+    fclose(f);
+}
+
+static void analyze(const char *name)
+{
+    u32 writes = 0, unchanged = 0, touched = 0, rewritten = 0;
+    
+    lcd_dma_wait();
+    for (int y = 0; y < LCD_HEIGHT; y++) {
+        for (int x = 0; x < LCD_WIDTH; x++) {
+            writes += host_lcd_writes[y][x];
+            unchanged += host_lcd_unchanged[y][x];
+            if (host_lcd_writes[y][x]) touched++;
+            if (host_lcd_writes[y][x] > 1) rewritten++;
+        }
+    }
+    // overdraw: writes per pixel touched; 1.00 means nothing was drawn twice
+    printf("%-18s %8u %8u %8u %9.2f %8u %8.1f%%\n", name, writes, touched, rewritten,
+           touched ? (double)writes / touched : 0.0, unchanged,
+           writes ? 100.0 * unchanged / writes : 0.0);
+    write_heatmap(name, "writes", host_lcd_writes);
+    write_heatmap(name, "unchanged", host_lcd_unchanged);
+}
+
+#define FRAME(name, call) do {          \
+        host_lcd_reset_overdraw();      \
+        call;                           \
+        analyze(name);                  \
+    } while (0)
+
+int main(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-o") && i + 1 < argc) out_dir = argv[++i];
+        else {
+            fprintf(stderr, "usage: %s [-o dir]\n", argv[0]);
+            return 2;
+        }
+    }
+    
+    host_lcd_reset();
+    lcd_init();
+    
+    printf("%-18s %8s %8s %8s %9s %8s %9s\n", "frame",
+           "writes", "pixels", "multi", "overdraw", "same", "same%");
+    FRAME("start", draw_start_screen());
+    FRAME("instructions", draw_instructions_screen());
+    srand(3810);
+    init_grid_no_matches();
+    FRAME("draw_frame", draw_frame());
+    FRAME("draw_grid_stable", draw_grid_stable());
+    FRAME("draw_ui_bar", draw_ui_bar());
+    FRAME("gameover", draw_gameover_screen());
+    return 0;
+}
@@ -0,0 +1,56 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "stm32f10x.h"
+#include "IERG3810_TFTLCD.h"
+#include "host_lcd.h"
+#include "host_game.h"
+#include "host_hal.h"
+
+// Runs the real main() of User/project.c on the emulated board, in virtual
+// time (host_hal.c), driven by an input script:
+//
+//   lcd_sim script.sim
+//
+// One step per line, "<ms> <command> [args]", in time order; # comments.
+//   key1 | keyup              press and hold the button for HOST_BUTTON_MS
+//   ps2 <hex> [<hex>...]      send scancode bytes through EXTI15_10
+//   ppm <file>                dump the framebuffer
+//   expect state <MENU|INSTRUCTIONS|GAME|GAMEOVER>
+//   expect timer|score|dropped <n>
+//                             check game_timer_seconds / score / ps2_dropped
+//   print                     show time, state, timer and score
+//   quit                      stop (also implied after the last step)
+// Exit status is 1 if any expect failed.
+
+static struct timespec wall_start;
+
+static void report(void)
+{
+    struct timespec now;
+    double wall, virt = (double)host_time / HOST_HCLK_HZ;
+    
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    wall = (now.tv_sec - wall_start.tv_sec) + (now.tv_nsec - wall_start.tv_nsec) / 1e9;
+    fflush(stdout);
+    fprintf(stderr, "lcd_sim: %.2f s virtual in %.3f s (%.0fx), %d failed\n",
+            virt, wall, wall > 0 ? virt / wall : 0.0, host_hal_failures());
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s script.sim\n", argv[0]);
+        return 2;
+    }
+    host_lcd_reset();
+    host_hal_init();
+    if (host_hal_load(argv[1]) < 0) return 2;
+    
+    clock_gettime(CLOCK_MONOTONIC, &wall_start);
+    atexit(report);
+    setvbuf(stdout, 0, _IOLBF, 0);
+    project_main();     // never returns: the script's end exits
+    return 0;
+}
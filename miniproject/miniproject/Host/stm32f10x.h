@@ -0,0 +1,100 @@
+#ifndef __HOST_STM32F10X_H
+#define __HOST_STM32F10X_H
+
+// Linux shim for stm32f10x.h.
+// Put Host in front of the Keil include path (-IHost -IBoard -ICore
+// -IFw_lib/inc -IUser) and every "stm32f10x.h" include lands here first.
+// The real device header still provides all types and bit definitions; only
+// the peripheral pointers are redirected into ordinary RAM (Host/host_periph.c)
+// so the Board drivers and Fw_lib can run unmodified on a PC.
+#include "../Core/stm32f10x.h"
+
+#define HOST_BUILD 1
+
+#undef GPIOA
+#undef GPIOB
+#undef GPIOC
+#undef GPIOD
+#undef GPIOE
+#undef GPIOF
+#undef GPIOG
+#undef AFIO
+#undef EXTI
+#undef RCC
+#undef FLASH
+#undef USART1
+#undef USART2
+#undef DMA1
+#undef DMA2
+#undef DMA1_Channel1
+#undef DMA1_Channel2
+#undef DMA1_Channel3
+#undef DMA1_Channel4
+#undef DMA1_Channel5
+#undef DMA1_Channel6
+#undef DMA1_Channel7
+#undef DMA2_Channel1
+#undef DMA2_Channel2
+#undef DMA2_Channel3
+#undef DMA2_Channel4
+#undef DMA2_Channel5
+#undef FSMC_Bank1
+#undef FSMC_Bank1E
+#undef SCB
+#undef SysTick
+#undef NVIC
+#undef CoreDebug
+
+extern GPIO_TypeDef host_GPIO[7];
+extern AFIO_TypeDef host_AFIO;
+extern EXTI_TypeDef host_EXTI;
+extern RCC_TypeDef host_RCC;
+extern FLASH_TypeDef host_FLASH;
+extern USART_TypeDef host_USART1;
+extern USART_TypeDef host_USART2;
+extern DMA_TypeDef host_DMA1;
+extern DMA_TypeDef host_DMA2;
+extern DMA_Channel_TypeDef host_DMA1_Channel[7];
+extern DMA_Channel_TypeDef host_DMA2_Channel[5];
+extern FSMC_Bank1_TypeDef host_FSMC_Bank1;
+extern FSMC_Bank1E_TypeDef host_FSMC_Bank1E;
+extern SCB_Type host_SCB;
+extern SysTick_Type host_SysTick;
+extern NVIC_Type host_NVIC;
+extern CoreDebug_Type host_CoreDebug;
+
+#define GPIOA           (&host_GPIO[0])
+#define GPIOB           (&host_GPIO[1])
+#define GPIOC           (&host_GPIO[2])
+#define GPIOD           (&host_GPIO[3])
+#define GPIOE           (&host_GPIO[4])
+#define GPIOF           (&host_GPIO[5])
+#define GPIOG           (&host_GPIO[6])
+#define AFIO            (&host_AFIO)
+#define EXTI            (&host_EXTI)
+#define RCC             (&host_RCC)
+#define FLASH           (&host_FLASH)
+#define USART1          (&host_USART1)
+#define USART2          (&host_USART2)
+#define DMA1            (&host_DMA1)
+#define DMA2            (&host_DMA2)
+#define DMA1_Channel1   (&host_DMA1_Channel[0])
+#define DMA1_Channel2   (&host_DMA1_Channel[1])
+#define DMA1_Channel3   (&host_DMA1_Channel[2])
+#define DMA1_Channel4   (&host_DMA1_Channel[3])
+#define DMA1_Channel5   (&host_DMA1_Channel[4])
+#define DMA1_Channel6   (&host_DMA1_Channel[5])
+#define DMA1_Channel7   (&host_DMA1_Channel[6])
+#define DMA2_Channel1   (&host_DMA2_Channel[0])
+#define DMA2_Channel2   (&host_DMA2_Channel[1])
+#define DMA2_Channel3   (&host_DMA2_Channel[2])
+#define DMA2_Channel4   (&host_DMA2_Channel[3])
+#define DMA2_Channel5   (&host_DMA2_Channel[4])
+#define FSMC_Bank1      (&host_FSMC_Bank1)
+#define FSMC_Bank1E     (&host_FSMC_Bank1E)
+#define SCB             (&host_SCB)
+#define SysTick         (&host_SysTick)
+#define NVIC            (&host_NVIC)
+#define CoreDebug       (&host_CoreDebug)
+
+#endif
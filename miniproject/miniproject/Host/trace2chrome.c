@@ -0,0 +1,83 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Converts a trace_dump (Board/IERG3810_Trace.c) captured from USART2 into
+// Chrome trace-event JSON for chrome://tracing or Perfetto.
+//
+//   trace2chrome < capture.txt > trace.json
+//
+// Anything before the TRACE line (other telemetry) is skipped. Main-loop
+// events go on tid 1, events logged inside an ISR on tid 2. The 32-bit
+// cycle counter is unwrapped assuming no gap of a full wrap (~60 s at 72 MHz)
+// between events. End events whose begin fell off the ring are dropped.
+
+#define MAX_IDS 256
+
+static char names[MAX_IDS][32];
+static int depth[2][MAX_IDS];
+
+static void print_event(const char *name, char ph, int tid, double ts, unsigned arg)
+{
+    printf(",\n  {\"name\": \"%s\", \"ph\": \"%c\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f",
+           name, ph, tid, ts);
+    if (ph == 'i') printf(", \"s\": \"t\"");
+    printf(", \"args\": {\"arg\": %u}}", arg);
+}
+
+int main(void)
+{
+    char line[256];
+    unsigned mhz = 72, events = 0;
+    unsigned long long now = 0;
+    unsigned prev = 0;
+    int started = 0, have_prev = 0, written = 0;
+    
+    while (fgets(line, sizeof(line), stdin)) {
+        if (sscanf(line, "TRACE %u %u", &events, &mhz) == 2) {
+            started = 1;
+            break;
+        }
+    }
+    if (!started || mhz == 0) {
+        fprintf(stderr, "trace2chrome: no TRACE header in input\n");
+        return 1;
+    }
+    
+    printf("{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n"
+           "  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 1, \"args\": {\"name\": \"main loop\"}},\n"
+           "  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 2, \"args\": {\"name\": \"interrupts\"}}");
+    
+    while (fgets(line, sizeof(line), stdin)) {
+        unsigned id, arg, isr, cycles;
+        char ph;
+        
+        if (!strncmp(line, "END", 3)) break;
+        if (line[0] == 'N') {
+            char name[32];
+            if (sscanf(line, "N %u %31s", &id, name) == 2 && id < MAX_IDS) strcpy(names[id], name);
+            continue;
+        }
+        if (sscanf(line, "%x %c %u %u %u", &cycles, &ph, &isr, &id, &arg) != 5 || id >= MAX_IDS) continue;
+        
+        if (have_prev) now += (unsigned)(cycles - prev);
+        prev = cycles;
+        have_prev = 1;
+        isr = isr ? 1 : 0;
+        if (!names[id][0]) snprintf(names[id], sizeof(names[id]), "event%u", id);
+        
+        if (ph == 'B') {
+            depth[isr][id]++;
+        } else if (ph == 'E') {
+            if (depth[isr][id] == 0) continue;
+            depth[isr][id]--;
+        } else {
+            ph = 'i';
+        }
+        print_event(names[id], ph, isr + 1, (double)now / mhz, arg);
+        written++;
+    }
+    printf("\n]}\n");
+    fprintf(stderr, "trace2chrome: %d of %u events\n", written, events);
+    return 0;
+}
@@ -1,12 +1,20 @@
 #include "stm32f10x.h"
 #include "stdlib.h"
 #include "stdio.h"
+#include "string.h"
 #include "IERG3810_LED.h"
 #include "IERG3810_KEY.h"
 #include "IERG3810_Buzzer.h"
 #include "IERG3810_Clock.h"
 #include "IERG3810_TFTLCD.h"
 #include "IERG3810_USART.h"
+#include "IERG3810_Profile.h"
+#include "IERG3810_Trace.h"
+#include "GEMSPRITE.H"
+#include "GAMESTATE.H"
+#ifdef HOST_BUILD
+#include "host_hal.h"
+#endif
 
 // ==========================================
 // COLOR DEFINITIONS
@@ -58,22 +66,24 @@
 
 #define TOTAL_GAME_TIME 180  
 
+// 1 = menus and full board go through lcd_renderStrips (ping-pong DMA),
+// 0 = the direct-write path (draw_frame + lcd_showString, line-by-line board).
+// Host/Makefile builds lcd_golden_nostrip with 0.
+#ifndef STRIP_RENDER
+#define STRIP_RENDER    1
+#endif
+
 
 // ==========================================
 // GLOBAL VARIABLES
 // ==========================================
-typedef enum {
-    STATE_MENU,
-    STATE_INSTRUCTIONS,
-    STATE_GAME,
-    STATE_GAMEOVER
-} GameState;
-
 GameState current_state = STATE_MENU;
 
 // Inputs
 volatile u32 ps2count = 0;
 volatile u32 ps2key = 0;
+volatile u32 ps2key_stamp = 0;  // prof_now() when ps2key's stop bit arrived
+volatile u32 ps2_dropped = 0;   // bad stop bits + make codes overwritten before being read
 int key_debounce = 0;
 
 // Game Logic
@@ -82,10 +92,67 @@ int cursor_x = 4;
 int cursor_y = 4;           
 int is_selected = 0;        
 int game_timer_seconds = TOTAL_GAME_TIME;
+int ui_bar_drawn = 0;       // bar background still on screen (draw_frame wipes it)
+int hud_shown = 0;          // performance HUD toggled on (PS2_NUM_MINUS)
+int hud_on_screen = 0;      // hud_drawn[] matches the bezel (full-screen draws clear it)
 volatile int systick_counter = 0; 
 // Random Seed Counter
 volatile int seed_counter = 0;
 
+// Profiling zones (IERG3810_Profile), dumped over USART2 with PS2_NUM_STAR
+enum {
+    ZONE_MATCHES,
+    ZONE_GRAVITY,
+    ZONE_GRID,
+    ZONE_UI_BAR,
+    ZONE_INPUT,
+    ZONE_PS2_IRQ,
+    ZONE_COUNT
+};
+const char *const ZONE_NAMES[ZONE_COUNT] = {
+    "find_matches", "gravity", "draw_grid", "draw_ui_bar", "keyboard_input", "ps2_irq"
+};
+
+// Input-to-photon latency: key stop bit to the last LCD write of its action
+enum {
+    LAT_MOVE,       // cursor redraw
+    LAT_SELECT,     // selection ring toggled
+    LAT_SWAP,       // swap that matched: end of the cascade and score bar
+    LAT_SWAP_BACK,  // rejected swap drawn back
+    LAT_SPECIAL,    // clearer / bomb and its cascade
+    LAT_COUNT
+};
+const char *const LAT_NAMES[LAT_COUNT] = {
+    "move", "select", "swap", "swap_back", "special"
+};
+
+// Trace events (IERG3810_Trace), dumped over USART2 with PS2_NUM_PLUS
+enum {
+    TR_STATE,       // I: arg = new GameState
+    TR_SWAP,        // I: arg = x1 | y1 << 4 | x2 << 8 | y2 << 12
+    TR_MATCHES,     // B/E: find_and_clear_matches, end arg = matches found
+    TR_GRAVITY,     // B/E: gravity_collapse, end arg = longest fall
+    TR_GRAVITY_PASS,// B/E: one frame of a fall in play_events, arg = frame number
+    TR_DRAW_FRAME,
+    TR_DRAW_GRID,
+    TR_FLUSH,       // B/E: flush_board, end arg = tiles redrawn
+    TR_DRAW_TILE,   // B/E: arg = x | y << 4
+    TR_UI_BAR,
+    TR_TEXT_SCREEN,
+    TR_PS2_IRQ,     // I: arg = bit count before this edge
+    TR_SYSTICK,     // I
+    TR_COUNT
+};
+const char *const TR_NAMES[TR_COUNT] = {
+    "state", "swap", "find_matches", "gravity", "fall_frame", "draw_frame",
+    "draw_grid", "flush_board", "draw_tile", "draw_ui_bar", "text_screen", "ps2_irq", "systick"
+};
+
+void set_state(GameState state) {
+    TRACE_I(TR_STATE, state);
+    current_state = state;
+}
+
 // Tile colors
 const u16 GEM_COLORS[] = {RED, GREEN, BLUE, YELLOW, ORANGE, MAGENTA};
 #define NUM_COLORS 6
@@ -96,7 +163,78 @@ const u16 GEM_COLORS[] = {RED, GREEN, BLUE, YELLOW, ORANGE, MAGENTA};
 #define VERTICAL_CLEARER 2
 #define BOMB 3
 
-int grid[GRID_SIZE][GRID_SIZE][2];
+// One byte per cell: bits 2..0 = colour + 1 (0 = empty), bits 4..3 = type.
+// The whole board is 81 bytes, so a snapshot of it is a single memcpy.
+#define CELL_COLOR_MASK 0x07
+#define CELL_TYPE_SHIFT 3
+#define CELL_EMPTY      0
+#define MAKE_CELL(type, color)  ((u8)(((type) << CELL_TYPE_SHIFT) | ((color) + 1)))
+#define CELL_COLOR(cell)        (((cell) & CELL_COLOR_MASK) - 1)
+#define CELL_TYPE(cell)         ((cell) >> CELL_TYPE_SHIFT)
+
+u8 grid[GRID_SIZE][GRID_SIZE];  // [y][x]
+
+// Rows (bit y) and columns (bit x) changed since find_and_clear_matches last
+// ran. Lines outside them hold no NORMAL three-in-a-line, so it skips them.
+u16 dirty_rows = 0x1FF;
+u16 dirty_cols = 0x1FF;
+#define MARK_DIRTY(x, y)    (dirty_rows |= 1 << (y), dirty_cols |= 1 << (x))
+
+#define TILE_COLOR(x, y)            CELL_COLOR(grid[y][x])  // -1 = empty
+#define TILE_TYPE(x, y)             CELL_TYPE(grid[y][x])
+#define TILE_EMPTY(x, y)            (!(grid[y][x] & CELL_COLOR_MASK))
+#define SET_TILE(x, y, type, color) (grid[y][x] = MAKE_CELL(type, color), MARK_DIRTY(x, y))
+#define SET_TILE_TYPE(x, y, type)   (grid[y][x] = (grid[y][x] & CELL_COLOR_MASK) | ((type) << CELL_TYPE_SHIFT), MARK_DIRTY(x, y))
+#define CLEAR_TILE(x, y)            (grid[y][x] = CELL_EMPTY, MARK_DIRTY(x, y))
+
+// ==========================================
+// EVENT LOG
+// ==========================================
+// The game logic (swap, matches, specials, gravity) only changes grid[][]
+// and appends what it did here. play_events() turns the log into frames
+// afterwards, at its own pace, starting from the board event_begin() saved.
+enum {
+    EV_SWAP,        // pos <-> arg & 0xFF
+    EV_BLAST,       // special at pos fired, arg = its type
+    EV_CLEAR,       // pos emptied, arg = the cell it held
+    EV_SPECIAL,     // pos became special, arg = type
+    EV_SCORE,       // arg = points added
+    EV_MOVE,        // tile arg & 0xFF fell arg >> 8 rows into pos
+    EV_SPAWN,       // refill arg & 0xFF dropped arg >> 8 rows from above the board into pos
+    EV_SETTLE       // gravity step done, arg = longest fall
+};
+
+typedef struct {
+    u8 kind;
+    u8 pos;         // x | y << 4
+    u16 arg;
+} BoardEvent;
+
+#define EVENT_LOG_SIZE  512
+#define EVENT_POS(x, y) ((x) | (y) << 4)
+
+BoardEvent event_log[EVENT_LOG_SIZE];
+int event_count = 0;
+int event_overflow = 0;             // log ran out: play_events only shows the result
+u8 view[GRID_SIZE][GRID_SIZE];      // the board as the log played so far leaves it
+int score_pending = 0;              // points in the log not played yet (draw_ui_bar holds them back)
+
+void event_begin(void) {
+    memcpy(view, grid, sizeof(view));
+    event_count = 0;
+    event_overflow = 0;
+}
+
+void log_event(u8 kind, int x, int y, u16 arg) {
+    if (event_count == EVENT_LOG_SIZE) {
+        event_overflow = 1;
+        return;
+    }
+    event_log[event_count].kind = kind;
+    event_log[event_count].pos = EVENT_POS(x, y);
+    event_log[event_count].arg = arg;
+    event_count++;
+}
 
 // PS2 Codes
 #define PS2_NUM2    0x72  
@@ -105,6 +243,8 @@ int grid[GRID_SIZE][GRID_SIZE][2];
 #define PS2_NUM6    0x74  
 #define PS2_NUM8    0x75  
 #define PS2_NUM_MINUS 0x4A // PS/2 code for '-'. Update if your hardware is different.
+#define PS2_NUM_STAR  0x7C // keypad '*': profiling table to USART2
+#define PS2_NUM_PLUS  0x79 // keypad '+': trace ring to USART2
 
 // Buzzer
 #define BUZZER_ON  (GPIOB->BSRR = 1 << 8)
@@ -114,8 +254,12 @@ int grid[GRID_SIZE][GRID_SIZE][2];
 // HARDWARE INIT & INTERRUPTS
 // ==========================================
 void Delay(u32 count) {
+#ifdef HOST_BUILD
+    host_delay(count);  // virtual time: SysTick and scripted input happen here
+#else
     u32 i;
     for (i = 0; i < count; i++);
+#endif
 }
 
 void IERG3810_NVIC_SetPriorityGroup(u8 prigroup) {
@@ -147,6 +291,10 @@ void IERG3810_PS2key_ExtiInit(void) {
 
 void EXTI15_10_IRQHandler(void) {
     static u32 shift_reg = 0;
+    static u32 last_code = 0;
+    static u8 ps2key_break = 0;     // the code in ps2key is a release (came after 0xF0)
+    PROF_BEGIN(ZONE_PS2_IRQ);
+    TRACE_I(TR_PS2_IRQ, ps2count);
     if (EXTI->PR & (1 << 11)) {
         u32 data_bit = (GPIOC->IDR & (1 << 10)) ? 1 : 0;
         if (ps2count == 0) {
@@ -161,12 +309,21 @@ void EXTI15_10_IRQHandler(void) {
             ps2count++;
         } else if (ps2count == 10) {
             if (data_bit == 1) {
+                // The F0 + code of a release usually lands while key_debounce
+                // leaves ps2key unread; only an unread make code is a lost key
+                if (ps2key != 0 && ps2key != 0xF0 && ps2key != 0xE0 && !ps2key_break) ps2_dropped++;
+                ps2key_break = (last_code == 0xF0);
+                last_code = shift_reg;
                 ps2key = shift_reg;
+                ps2key_stamp = prof_now();
+            } else {
+                ps2_dropped++;
             }
             ps2count = 0;
         }
         EXTI->PR = 1 << 11; 
     }
+    PROF_END(ZONE_PS2_IRQ);
 }
 
 void IERG3810_SYSTICK_Init10ms(void) {
@@ -176,6 +333,7 @@ void IERG3810_SYSTICK_Init10ms(void) {
 }
 
 void SysTick_Handler(void) {
+    TRACE_I(TR_SYSTICK, 0);
     if (key_debounce > 0) key_debounce--;
     
     // Countdown logic
@@ -186,7 +344,7 @@ void SysTick_Handler(void) {
             if (game_timer_seconds > 0) {
                 game_timer_seconds--;
             } else {
-                current_state = STATE_GAMEOVER;
+                set_state(STATE_GAMEOVER);
             }
         }
     }
@@ -196,143 +354,141 @@ void SysTick_Handler(void) {
 // GRAPHICS & RENDERER
 // ==========================================
 
+// ==========================================
+// RENDERED BOARD SHADOW
+// ==========================================
+// What each cell currently shows on the LCD. flush_board() compares it with
+// grid[][] and the cursor and only redraws cells that differ.
+typedef struct {
+    u8 cell;            // as in grid[][]
+    u8 cursor;          // 0 = none, 1 = cursor, 2 = cursor + selected
+} RenderedCell;
+
+RenderedCell shadow[GRID_SIZE][GRID_SIZE];
+int shadow_valid = 0;           // cleared whenever the board area is wiped
+int last_flush_redraws = 0;     // tiles redrawn by the most recent flush_board()
+
+u8 cell_cursor_state(int x, int y) {
+    if (x != cursor_x || y != cursor_y) return 0;
+    return is_selected ? 2 : 1;
+}
+
+void shadow_record(int x, int y, u8 cell) {
+    shadow[y][x].cell = cell;
+    shadow[y][x].cursor = cell_cursor_state(x, y);
+}
+
+// Text placed on a menu screen (always on SCREEN_BG_COLOR)
+typedef struct {
+    u16 x;
+    u16 y;
+    const char *text;
+    u16 color;
+} ScreenText;
+
+const ScreenText FRAME_CAPTION = {80, 290, "IERG3810", WHITE};
+
 void draw_frame(void) {
+    TRACE_B(TR_DRAW_FRAME, 0);
     // 1. Draw the Bezel
     lcd_fillRectangle(FRAME_COLOR, 0, 240, 0, 320);
     // 2. Draw the Active Screen
     lcd_fillRectangle(SCREEN_BG_COLOR, SCREEN_MIN_X, SCREEN_MAX_X - SCREEN_MIN_X, SCREEN_MIN_Y, SCREEN_MAX_Y - SCREEN_MIN_Y);
     // 3. Optional Text
-    lcd_showString(80, 290, "IERG3810", WHITE, FRAME_COLOR); 
+    lcd_showString(FRAME_CAPTION.x, FRAME_CAPTION.y, FRAME_CAPTION.text, FRAME_CAPTION.color, SCREEN_BG_COLOR); 
+    ui_bar_drawn = 0;
+    shadow_valid = 0;
+    hud_on_screen = 0;
+    TRACE_E(TR_DRAW_FRAME, 0);
+}
+
+// ==========================================
+// GEM SPRITES
+// ==========================================
+// Every (colour, type) tile is pre-rasterised at build time into GEMSPRITE.H
+// as 4-bpp palette indices (~5 KB of flash). A tile is one window and 400
+// pixels expanded through GEM_PALETTE; the cursor ring is swapped in by the
+// blit rather than stored.
+const u16 GEM_PALETTE[16] = {
+    GRID_BG_COLOR, CELL_BORDER, WHITE,          // PAL_GRID_BG, PAL_BORDER, PAL_WHITE
+    RED, GREEN, BLUE, YELLOW, ORANGE, MAGENTA   // PAL_RED == PAL_GEM0: GEM_COLORS in order
+};
+
+const u8 *get_jewel_sprite(int color_index, int type) {
+    int idx = (color_index == -1) ? 0 : 1 + color_index * 4 + type;
+    return gem_sprites[idx];
 }
 
-// *** VISUAL UPDATE: Draw Tile Background + Jewel ***
 void draw_jewel_tile(int x_pos, int y_pos, int color_index, int type) {
-    // 1. Draw Cell Background (The Frame)
-    lcd_fillRectangle(GRID_BG_COLOR, x_pos, TILE_SIZE, y_pos, TILE_SIZE);
-    
-    // 2. Draw Cell Border
-    lcd_fillRectangle(CELL_BORDER, x_pos, TILE_SIZE, y_pos, 1); // Bottom
-    lcd_fillRectangle(CELL_BORDER, x_pos, TILE_SIZE, y_pos + TILE_SIZE - 1, 1); // Top
-    lcd_fillRectangle(CELL_BORDER, x_pos, 1, y_pos, TILE_SIZE); // Left
-    lcd_fillRectangle(CELL_BORDER, x_pos + TILE_SIZE - 1, 1, y_pos, TILE_SIZE); // Right
-    
-    // If empty, just return (we drew the empty cell bg)
-    if (color_index == -1) return;
-
-    // Center coordinates for shapes
-    int cx = x_pos + 10;
-    int cy = y_pos + 10;
-    u16 color = GEM_COLORS[color_index];
-    int i, width, start_x;
-    
-    // 3. Draw Geometric Shape (Slightly smaller to fit in frame)
-    switch(color_index) {
-        case 0: // RED -> SQUARE
-            lcd_fillRectangle(color, x_pos + 5, 10, y_pos + 5, 10);
-            break;
-            
-        case 1: // GREEN -> CIRCLE
-            lcd_fillRectangle(color, x_pos + 7, 6, y_pos + 4, 1);
-            lcd_fillRectangle(color, x_pos + 5, 10, y_pos + 5, 1);
-            lcd_fillRectangle(color, x_pos + 4, 12, y_pos + 6, 8); 
-            lcd_fillRectangle(color, x_pos + 5, 10, y_pos + 14, 1);
-            lcd_fillRectangle(color, x_pos + 7, 6, y_pos + 15, 1);
-            break;
-            
-        case 2: // BLUE -> DIAMOND
-            for (i = 0; i < 6; i++) {
-                width = 2 * i + 1; 
-                start_x = cx - i;
-                lcd_fillRectangle(color, start_x, width, cy + (5 - i), 1);
-                lcd_fillRectangle(color, start_x, width, cy - (5 - i), 1);
-            }
-            lcd_fillRectangle(color, x_pos + 4, 13, cy, 1);
-            break;
-            
-        case 3: // YELLOW -> PENTAGON
-             // Top Triangle
-            for (i = 0; i < 5; i++) {
-                width = 2 * i + 2; 
-                start_x = cx - (width / 2);
-                lcd_fillRectangle(color, start_x, width, cy - 5 + i, 1);
-            }
-            // Base
-            for (i = 0; i < 6; i++) {
-                width = 10 - i; 
-                start_x = cx - (width / 2);
-                lcd_fillRectangle(color, start_x, width, cy + i, 1);
-            }
-            break;
-            
-        case 4: // ORANGE -> TRIANGLE (Down)
-            for (i = 0; i < 11; i++) {
-                width = 11 - i; 
-                lcd_fillRectangle(color, cx - (width/2), width, y_pos + 5 + i, 1);
-            }
-            break;
-            
-        case 5: // MAGENTA -> PLUS
-            lcd_fillRectangle(color, x_pos + 8, 4, y_pos + 3, 14); // Vertical
-            lcd_fillRectangle(color, x_pos + 3, 14, y_pos + 8, 4); // Horizontal
-            break;
-    }
-    
-    // 4. Special Markers
-    if (type == HORIZONTAL_CLEARER) {
-        lcd_fillRectangle(WHITE, x_pos + 3, 14, cy - 1, 2);
-    } else if (type == VERTICAL_CLEARER) {
-        lcd_fillRectangle(WHITE, cx - 1, 2, y_pos + 3, 14);
-    } else if (type == BOMB) {
-        lcd_fillRectangle(WHITE, cx - 3, 6, cy - 3, 6);
-        lcd_drawDot(cx, cy, RED);
-    }
+    lcd_drawIndexed(get_jewel_sprite(color_index, type), GEM_SPRITE_BPP, GEM_PALETTE, x_pos, TILE_SIZE, y_pos, TILE_SIZE);
 }
 
-// *** OPTIMIZATION: Helper to draw a single tile at grid coords ***
-void draw_single_tile(int x, int y) {
+// Draws cell at grid coords (x, y), which need not be what grid[y][x] holds
+// (falling tiles pass through cells on their way down)
+void draw_cell(int x, int y, u8 cell) {
     int tile_x = MARGIN_X + x * TILE_SIZE;
     int tile_y = GRID_BASE_Y + (y * TILE_SIZE);
     
-    int color_idx = grid[y][x][1];
-    int type = grid[y][x][0];
+    int color_idx = CELL_COLOR(cell);
+    int type = CELL_TYPE(cell);
     
-    // Draw the tile content (Background + Jewel)
-    draw_jewel_tile(tile_x, tile_y, color_idx, type);
+    TRACE_B(TR_DRAW_TILE, x | y << 4);
+    shadow_record(x, y, cell);
     
-    // Check if Cursor is here -> Draw Selection Border over it
+    // Check if Cursor is here -> 2px selection border replaces the tile edge
     if (x == cursor_x && y == cursor_y) {
         u16 border_color = is_selected ? RED : WHITE;
-        // Draw 2px thick border
-        for (int i = 0; i < 2; i++) {
-            lcd_fillRectangle(border_color, tile_x + i, TILE_SIZE - 2*i, tile_y + i, 1);
-            lcd_fillRectangle(border_color, tile_x + i, TILE_SIZE - 2*i, tile_y + TILE_SIZE - 1 - i, 1);
-            lcd_fillRectangle(border_color, tile_x + i, 1, tile_y + i, TILE_SIZE - 2*i);
-            lcd_fillRectangle(border_color, tile_x + TILE_SIZE - 1 - i, 1, tile_y + i, TILE_SIZE - 2*i);
-        }
+        lcd_drawIndexedFramed(get_jewel_sprite(color_idx, type), GEM_SPRITE_BPP, GEM_PALETTE, tile_x, TILE_SIZE, tile_y, TILE_SIZE, 2, border_color);
+    } else {
+        draw_jewel_tile(tile_x, tile_y, color_idx, type);
     }
+    TRACE_E(TR_DRAW_TILE, x | y << 4);
+}
+
+// *** OPTIMIZATION: Helper to draw a single tile at grid coords ***
+void draw_single_tile(int x, int y) {
+    draw_cell(x, y, grid[y][x]);
+}
+
+// Would (x, y) sit in a NORMAL three-in-a-line? Looks two cells each way.
+int cell_in_line(int x, int y) {
+    u8 cell = grid[y][x];
+    int h = 1, v = 1;
+    if (CELL_TYPE(cell) != NORMAL_TILE || cell == CELL_EMPTY) return 0;
+    for (int i = x - 1; i >= 0 && i >= x - 2 && grid[y][i] == cell; i--) h++;
+    for (int i = x + 1; i < GRID_SIZE && i <= x + 2 && grid[y][i] == cell; i++) h++;
+    for (int i = y - 1; i >= 0 && i >= y - 2 && grid[i][x] == cell; i--) v++;
+    for (int i = y + 1; i < GRID_SIZE && i <= y + 2 && grid[i][x] == cell; i++) v++;
+    return h >= 3 || v >= 3;
 }
 
 void init_grid_no_matches(void) {
     for (int y = 0; y < GRID_SIZE; y++) {
         for (int x = 0; x < GRID_SIZE; x++) {
-            grid[y][x][0] = NORMAL_TILE;
-            grid[y][x][1] = rand() % NUM_COLORS;
+            SET_TILE(x, y, NORMAL_TILE, rand() % NUM_COLORS);
         }
     }
     for (int y = 0; y < GRID_SIZE; y++) {
         for (int x = 0; x < GRID_SIZE - 2; x++) {
-            if (grid[y][x][1] == grid[y][x+1][1] && grid[y][x][1] == grid[y][x+2][1]) {
-                grid[y][x+1][1] = (grid[y][x+1][1] + 1) % NUM_COLORS;
+            if (TILE_COLOR(x, y) == TILE_COLOR(x+1, y) && TILE_COLOR(x, y) == TILE_COLOR(x+2, y)) {
+                SET_TILE(x+1, y, NORMAL_TILE, (TILE_COLOR(x+1, y) + 1) % NUM_COLORS);
             }
         }
     }
     for (int x = 0; x < GRID_SIZE; x++) {
         for (int y = 0; y < GRID_SIZE - 2; y++) {
-            if (grid[y][x][1] == grid[y+1][x][1] && grid[y][x][1] == grid[y+2][x][1]) {
-                grid[y+1][x][1] = (grid[y+1][x][1] + 1) % NUM_COLORS;
+            if (TILE_COLOR(x, y) == TILE_COLOR(x, y+1) && TILE_COLOR(x, y) == TILE_COLOR(x, y+2)) {
+                SET_TILE(x, y+1, NORMAL_TILE, (TILE_COLOR(x, y+1) + 1) % NUM_COLORS);
             }
         }
     }
+    // The repairs above can still leave a line; if they did, the board stays
+    // dirty and the first swap takes the full scan. Otherwise start settled.
+    int settled = 1;
+    for (int y = 0; y < GRID_SIZE && settled; y++)
+        for (int x = 0; x < GRID_SIZE && settled; x++)
+            if (cell_in_line(x, y)) settled = 0;
+    if (settled) dirty_rows = dirty_cols = 0;
     score = 0;
     cursor_x = GRID_SIZE / 2; 
     cursor_y = GRID_SIZE / 2; 
@@ -341,59 +497,463 @@ void init_grid_no_matches(void) {
 }
 
 void draw_ui_bar(void) {
-    lcd_fillRectangle(LIGHT_GREY, SCREEN_MIN_X, SCREEN_MAX_X - SCREEN_MIN_X, UI_BAR_Y, UI_BAR_HEIGHT);
+    PROF_BEGIN(ZONE_UI_BAR);
+    TRACE_B(TR_UI_BAR, 0);
+    // Text is opaque, so the bar only needs painting once per frame
+    if (!ui_bar_drawn) {
+        lcd_fillRectangle(LIGHT_GREY, SCREEN_MIN_X, SCREEN_MAX_X - SCREEN_MIN_X, UI_BAR_Y, UI_BAR_HEIGHT);
+        ui_bar_drawn = 1;
+    }
     char str[25];
-    sprintf(str, "PTS: %d", score);
+    sprintf(str, "PTS: %-5d", score - score_pending); // padded so a shorter score overwrites a longer one
     lcd_showString(SCREEN_MIN_X + 5, UI_BAR_Y + 5, str, BLACK, LIGHT_GREY);
     int min = game_timer_seconds / 60;
     int sec = game_timer_seconds % 60;
     sprintf(str, "TIME %02d:%02d", min, sec);
     lcd_showString(SCREEN_MIN_X + 110, UI_BAR_Y + 5, str, RED, LIGHT_GREY);
+    TRACE_E(TR_UI_BAR, 0);
+    PROF_END(ZONE_UI_BAR);
+}
+
+// ==========================================
+// BOARD COMPOSITOR
+// ==========================================
+// The board area (grid plus its 5px GRID_BG_COLOR margin) is built one
+// horizontal line at a time from grid[][], the sprites and the cursor state,
+// then streamed behind a single window: every pixel is written exactly once.
+#define BOARD_X         (MARGIN_X - 5)
+#define BOARD_Y         (GRID_BASE_Y - 5)
+#define BOARD_SIZE      ((GRID_SIZE * TILE_SIZE) + 10)
+#define SPRITE_STRIDE   ((TILE_SIZE * GEM_SPRITE_BPP + 7) / 8)  // bytes per sprite row
+#define SPRITE_MASK     ((1 << GEM_SPRITE_BPP) - 1)
+#if GEM_SPRITE_BPP > 4
+#error "GEM_PALETTE holds 16 entries; regenerate GEMSPRITE.H at 4 bpp or less"
+#endif
+
+u16 board_line[BOARD_SIZE];
+
+void compose_board_line(u16 *dst, int line) {
+    int ty = line - 5;
+    int i;
+    
+    if (ty < 0 || ty >= GRID_SIZE * TILE_SIZE) {
+        for (i = 0; i < BOARD_SIZE; i++) dst[i] = GRID_BG_COLOR;
+        return;
+    }
+    
+    int y = ty / TILE_SIZE;
+    int row = ty % TILE_SIZE;
+    
+    for (i = 0; i < 5; i++) *dst++ = GRID_BG_COLOR;
+    for (int x = 0; x < GRID_SIZE; x++) {
+        const u8 *p = get_jewel_sprite(TILE_COLOR(x, y), TILE_TYPE(x, y)) + row * SPRITE_STRIDE;
+#if GEM_SPRITE_BPP == 4
+        for (i = 0; i < TILE_SIZE; i += 2, p++) {
+            dst[i] = GEM_PALETTE[*p & 0x0F];
+            dst[i + 1] = GEM_PALETTE[*p >> 4];
+        }
+#else
+        // Any other depth GEMSPRITE.H is generated with: unpacked as
+        // lcd_drawIndexed does, a pixel at a time
+        int shift = 0;
+        for (i = 0; i < TILE_SIZE; i++) {
+            dst[i] = GEM_PALETTE[(*p >> shift) & SPRITE_MASK];
+            shift += GEM_SPRITE_BPP;
+            if (shift == 8) {
+                shift = 0;
+                p++;
+            }
+        }
+#endif
+        // Same 2px ring as draw_single_tile
+        if (x == cursor_x && y == cursor_y) {
+            u16 border_color = is_selected ? RED : WHITE;
+            if (row < 2 || row >= TILE_SIZE - 2) {
+                for (i = 0; i < TILE_SIZE; i++) dst[i] = border_color;
+            } else {
+                dst[0] = dst[1] = border_color;
+                dst[TILE_SIZE - 2] = dst[TILE_SIZE - 1] = border_color;
+            }
+        }
+        dst += TILE_SIZE;
+    }
+    for (i = 0; i < 5; i++) *dst++ = GRID_BG_COLOR;
+}
+
+void raster_board_strip(u16 *buf, u16 first_row, u16 rows) {
+    for (u16 r = 0; r < rows; r++) {
+        compose_board_line(buf + r * BOARD_SIZE, first_row + r);
+    }
 }
 
 // Full Grid Redraw (Used for Gravity/Matches/Start)
 void draw_grid_stable(void) {
-    // Clear the Grid Background Area
-    lcd_fillRectangle(GRID_BG_COLOR, MARGIN_X - 5, (GRID_SIZE * TILE_SIZE) + 10, GRID_BASE_Y - 5, (GRID_SIZE * TILE_SIZE) + 10);
-    
+    PROF_BEGIN(ZONE_GRID);
+    TRACE_B(TR_DRAW_GRID, 0);
+#if STRIP_RENDER
+    lcd_renderStrips(BOARD_X, BOARD_SIZE, BOARD_Y, BOARD_SIZE, raster_board_strip);
+#else
+    lcd_setWindow(BOARD_X, BOARD_SIZE, BOARD_Y, BOARD_SIZE);
+    for (int line = 0; line < BOARD_SIZE; line++) {
+        compose_board_line(board_line, line);
+        lcd_writePixels(board_line, BOARD_SIZE);
+    }
+#endif
     for (int y = 0; y < GRID_SIZE; y++) {
         for (int x = 0; x < GRID_SIZE; x++) {
-            draw_single_tile(x, y);
+            shadow_record(x, y, grid[y][x]);
         }
     }
+    shadow_valid = 1;
     draw_ui_bar();
+    TRACE_E(TR_DRAW_GRID, 0);
+    PROF_END(ZONE_GRID);
 }
 
-void draw_start_screen(void) {
+// Redraws only the cells whose colour, type or cursor state changed since
+// they were last drawn. Returns (and keeps in last_flush_redraws) the count.
+// With no valid shadow every cell is stale; the live grid then goes out as
+// one window, any other board (an event-log view) cell by cell.
+int flush_cells(u8 board[GRID_SIZE][GRID_SIZE]) {
+    int redrawn = 0;
+    
+    TRACE_B(TR_FLUSH, 0);
+    if (!shadow_valid && board == grid) {
+        draw_grid_stable();
+        last_flush_redraws = GRID_SIZE * GRID_SIZE;
+        TRACE_E(TR_FLUSH, last_flush_redraws);
+        return last_flush_redraws;
+    }
+    for (int y = 0; y < GRID_SIZE; y++) {
+        for (int x = 0; x < GRID_SIZE; x++) {
+            if (!shadow_valid || shadow[y][x].cell != board[y][x] ||
+                    shadow[y][x].cursor != cell_cursor_state(x, y)) {
+                draw_cell(x, y, board[y][x]);
+                redrawn++;
+            }
+        }
+    }
+    shadow_valid = 1;
+    last_flush_redraws = redrawn;
+    TRACE_E(TR_FLUSH, redrawn);
+    return redrawn;
+}
+
+int flush_board(void) {
+    return flush_cells(grid);
+}
+
+// How far each tile of the gravity step being played fell, by final cell.
+// Refills count from above the board: a column with k holes spawns k tiles
+// that all fell k.
+u8 fall_distance[GRID_SIZE][GRID_SIZE];
+
+// Intermediate frame of a fall onto board, 0 < frame < the longest fall:
+// every tile has dropped min(frame, its fall) rows, refills not yet in view
+// are hidden. Only the column segments above the lowest moved tile are
+// visited, and of those only cells that differ from the screen are drawn.
+int draw_fall_frame(u8 board[GRID_SIZE][GRID_SIZE], int frame) {
+    u8 column[GRID_SIZE];
+    int redrawn = 0;
+    
+    if (!shadow_valid) return 0;    // the final flush repaints everything
+    TRACE_B(TR_FLUSH, frame);
+    for (int x = 0; x < GRID_SIZE; x++) {
+        int lowest = 0;
+        while (lowest < GRID_SIZE && !fall_distance[lowest][x]) lowest++;
+        if (lowest == GRID_SIZE) continue;  // column didn't move
+        for (int y = lowest; y < GRID_SIZE; y++) column[y] = CELL_EMPTY;
+        for (int y = lowest; y < GRID_SIZE; y++) {
+            int drop = fall_distance[y][x] > frame ? fall_distance[y][x] - frame : 0;
+            if (y + drop < GRID_SIZE) column[y + drop] = board[y][x];
+        }
+        for (int y = lowest; y < GRID_SIZE; y++) {
+            if (shadow[y][x].cell != column[y] || shadow[y][x].cursor != cell_cursor_state(x, y)) {
+                draw_cell(x, y, column[y]);
+                redrawn++;
+            }
+        }
+    }
+    TRACE_E(TR_FLUSH, redrawn);
+    return redrawn;
+}
+
+// Replays the event log onto view[][] and the screen at the pace the game
+// always had: the swap held for a moment, a beep when it matched, the
+// cleared cells of a fired special, then every gravity step falling one row
+// per frame with the score bar after it. animate = 0 (or a log that
+// overflowed) skips straight to the final board.
+void play_events(int animate) {
+    int swaps = 0;
+    int beep = 0;
+    int blast = 0;
+    
+    score_pending = 0;
+    for (int i = 0; i < event_count; i++) {
+        if (event_log[i].kind == EV_SCORE) score_pending += event_log[i].arg;
+    }
+    if (!animate || event_overflow) {
+        memcpy(view, grid, sizeof(view));
+        score_pending = 0;
+        flush_board();
+        draw_ui_bar();
+        return;
+    }
+    memset(fall_distance, 0, sizeof(fall_distance));
+    for (int i = 0; i < event_count; i++) {
+        const BoardEvent *e = &event_log[i];
+        int x = e->pos & 0x0F, y = e->pos >> 4;
+        switch (e->kind) {
+            case EV_SWAP: {
+                int x2 = e->arg & 0x0F, y2 = (e->arg >> 4) & 0x0F;
+                u8 temp = view[y][x];
+                view[y][x] = view[y2][x2];
+                view[y2][x2] = temp;
+                draw_cell(x, y, view[y][x]);
+                draw_cell(x2, y2, view[y2][x2]);
+                beep = (swaps++ == 0);  // a swap back is never held or beeped
+                if (beep) Delay(50000);
+                break;
+            }
+            case EV_BLAST:
+                blast = 1;
+                break;
+            case EV_CLEAR:
+                if (beep) { BUZZER_ON; Delay(30000); BUZZER_OFF; beep = 0; }
+                view[y][x] = CELL_EMPTY;
+                break;
+            case EV_SPECIAL:
+                view[y][x] = (view[y][x] & CELL_COLOR_MASK) | (e->arg << CELL_TYPE_SHIFT);
+                break;
+            case EV_SCORE:
+                score_pending -= e->arg;
+                break;
+            case EV_MOVE:
+            case EV_SPAWN:
+            case EV_SETTLE:
+                if (blast) {        // show what the special cleared before it falls
+                    flush_cells(view);
+                    blast = 0;
+                }
+                if (e->kind != EV_SETTLE) {
+                    view[y][x] = e->arg & 0xFF;
+                    fall_distance[y][x] = e->arg >> 8;
+                    break;
+                }
+                for (int frame = 1; frame <= e->arg; frame++) {
+                    TRACE_B(TR_GRAVITY_PASS, frame);
+                    if (frame < e->arg) draw_fall_frame(view, frame);
+                    else flush_cells(view);
+                    Delay(60000);
+                    TRACE_E(TR_GRAVITY_PASS, frame);
+                }
+                memset(fall_distance, 0, sizeof(fall_distance));
+                draw_ui_bar();
+                break;
+        }
+    }
+    score_pending = 0;
+}
+
+// Texts of the menu screen being rasterised by raster_screen_strip
+const ScreenText *screen_texts;
+int screen_text_count;
+
+void raster_screen_line(u16 *line, u16 y, const ScreenText *t) {
+    if (y >= t->y && y < t->y + 16) {
+        lcd_textRow(line, 0, LCD_WIDTH, t->x, y - t->y, t->text, t->color, SCREEN_BG_COLOR);
+    }
+}
+
+// Bezel, active area and text, composed in the same order draw_frame and
+// lcd_showString would paint them
+void raster_screen_strip(u16 *buf, u16 first_row, u16 rows) {
+    for (u16 r = 0; r < rows; r++) {
+        u16 *line = buf + r * LCD_WIDTH;
+        u16 y = first_row + r;
+        int x;
+        for (x = 0; x < LCD_WIDTH; x++) line[x] = FRAME_COLOR;
+        if (y >= SCREEN_MIN_Y && y < SCREEN_MAX_Y) {
+            for (x = SCREEN_MIN_X; x < SCREEN_MAX_X; x++) line[x] = SCREEN_BG_COLOR;
+        }
+        raster_screen_line(line, y, &FRAME_CAPTION);
+        for (int i = 0; i < screen_text_count; i++) {
+            raster_screen_line(line, y, &screen_texts[i]);
+        }
+    }
+}
+
+void draw_text_screen(const ScreenText *texts, int count) {
+    TRACE_B(TR_TEXT_SCREEN, 0);
+#if STRIP_RENDER
+    screen_texts = texts;
+    screen_text_count = count;
+    lcd_renderStrips(0, LCD_WIDTH, 0, LCD_HEIGHT, raster_screen_strip);
+    ui_bar_drawn = 0;   // whole screen replaced, as with draw_frame
+    shadow_valid = 0;
+    hud_on_screen = 0;
+#else
     draw_frame();
-    lcd_showString(SCREEN_MIN_X + 60, 260, "JEWEL LEGEND", CYAN, SCREEN_BG_COLOR);
-    lcd_showString(SCREEN_MIN_X + 60, 200, "Designed by", WHITE, SCREEN_BG_COLOR);
-    lcd_showString(SCREEN_MIN_X + 35, 180, "1155184266 Lam Chi", WHITE, SCREEN_BG_COLOR);
-    lcd_showString(SCREEN_MIN_X + 100, 160, "&", WHITE, SCREEN_BG_COLOR);
-    lcd_showString(SCREEN_MIN_X + 20, 140, "1155214311 Yu Ho Ming", WHITE, SCREEN_BG_COLOR);
-    lcd_showString(SCREEN_MIN_X + 65, 60, "PRESS KEY 1", YELLOW, SCREEN_BG_COLOR);
-    lcd_showString(SCREEN_MIN_X + 70, 40, "TO START", YELLOW, SCREEN_BG_COLOR);
+    for (int i = 0; i < count; i++) {
+        lcd_showString(texts[i].x, texts[i].y, texts[i].text, texts[i].color, SCREEN_BG_COLOR);
+    }
+#endif
+    TRACE_E(TR_TEXT_SCREEN, 0);
+}
+
+void draw_start_screen(void) {
+    static const ScreenText texts[] = {
+        {SCREEN_MIN_X + 60, 260, "JEWEL LEGEND", CYAN},
+        {SCREEN_MIN_X + 60, 200, "Designed by", WHITE},
+        {SCREEN_MIN_X + 35, 180, "1155184266 Lam Chi", WHITE},
+        {SCREEN_MIN_X + 100, 160, "&", WHITE},
+        {SCREEN_MIN_X + 20, 140, "1155214311 Yu Ho Ming", WHITE},
+        {SCREEN_MIN_X + 65, 60, "PRESS KEY 1", YELLOW},
+        {SCREEN_MIN_X + 70, 40, "TO START", YELLOW},
+    };
+    draw_text_screen(texts, sizeof(texts) / sizeof(texts[0]));
 }
 
 void draw_instructions_screen(void) {
-    draw_frame();
-    lcd_showString(SCREEN_MIN_X + 40, 270,  "-- HOW TO PLAY --", WHITE, SCREEN_BG_COLOR);
-    lcd_showString(SCREEN_MIN_X + 30, 230,  "Key 8: UP", WHITE, SCREEN_BG_COLOR);
-    lcd_showString(SCREEN_MIN_X + 30, 210, "Key 2: DOWN", WHITE, SCREEN_BG_COLOR);
-    lcd_showString(SCREEN_MIN_X + 30, 190, "Key 4: LEFT", WHITE, SCREEN_BG_COLOR);
-    lcd_showString(SCREEN_MIN_X + 30, 170, "Key 6: RIGHT", WHITE, SCREEN_BG_COLOR);
-    lcd_showString(SCREEN_MIN_X + 30, 130, "Key 5: SELECT/SWAP", RED, SCREEN_BG_COLOR);
-    lcd_showString(SCREEN_MIN_X + 60, 60, "PRESS KEY 1", YELLOW, SCREEN_BG_COLOR);
+    static const ScreenText texts[] = {
+        {SCREEN_MIN_X + 40, 270, "-- HOW TO PLAY --", WHITE},
+        {SCREEN_MIN_X + 30, 230, "Key 8: UP", WHITE},
+        {SCREEN_MIN_X + 30, 210, "Key 2: DOWN", WHITE},
+        {SCREEN_MIN_X + 30, 190, "Key 4: LEFT", WHITE},
+        {SCREEN_MIN_X + 30, 170, "Key 6: RIGHT", WHITE},
+        {SCREEN_MIN_X + 30, 130, "Key 5: SELECT/SWAP", RED},
+        {SCREEN_MIN_X + 60, 60, "PRESS KEY 1", YELLOW},
+    };
+    draw_text_screen(texts, sizeof(texts) / sizeof(texts[0]));
 }
 
 void draw_gameover_screen(void) {
-    draw_frame();
-    lcd_showString(SCREEN_MIN_X + 70, 230, "GAME OVER", RED, SCREEN_BG_COLOR);
     char score_str[20];
     sprintf(score_str, "FINAL: %d", score);
-    lcd_showString(SCREEN_MIN_X + 75, 200, score_str, WHITE, SCREEN_BG_COLOR);
-    lcd_showString(SCREEN_MIN_X + 60, 60, "PRESS KEY UP", YELLOW, SCREEN_BG_COLOR);
-    lcd_showString(SCREEN_MIN_X + 70, 40, "TO RESET", YELLOW, SCREEN_BG_COLOR);
+    ScreenText texts[] = {
+        {SCREEN_MIN_X + 70, 230, "GAME OVER", RED},
+        {SCREEN_MIN_X + 75, 200, score_str, WHITE},
+        {SCREEN_MIN_X + 60, 60, "PRESS KEY UP", YELLOW},
+        {SCREEN_MIN_X + 70, 40, "TO RESET", YELLOW},
+    };
+    draw_text_screen(texts, sizeof(texts) / sizeof(texts[0]));
+}
+
+// ==========================================
+// PERFORMANCE HUD
+// ==========================================
+// One line of 3x5 digits in the bottom bezel (y 0..9, below SCREEN_MIN_Y):
+//   F<frame us> W<FSMC writes/frame> L<matches + gravity us/frame> D<dropped keys>
+// Values are averaged over HUD_PERIOD_MS; only characters that changed are
+// redrawn, 4x5 = 20 pixels each, so the HUD costs a few hundred writes a second.
+#define HUD_X           12
+#define HUD_Y           2
+#define HUD_CHARS       27
+#define HUD_COLOR       WHITE
+#define HUD_PERIOD_MS   1000
+
+// 3x5 glyphs, 3 bits per row, top row in bits 14..12
+const u16 HUD_FONT_DIGITS[10] = {
+    0x7B6F, 0x2C97, 0x73E7, 0x72CF, 0x5BC9, 0x79CF, 0x79EF, 0x7249, 0x7BEF, 0x7BCF
+};
+#define HUD_GLYPH_F     0x79A4
+#define HUD_GLYPH_W     0x5B7D
+#define HUD_GLYPH_L     0x4927
+#define HUD_GLYPH_D     0x6B6E
+
+char hud_text[HUD_CHARS + 1];       // latest values
+char hud_drawn[HUD_CHARS + 1];      // what the bezel shows
+u32 hud_last_stamp;
+u32 hud_frames, hud_cycles;
+#if LCD_BUS_STATS
+u32 hud_bus_base;
+#endif
+unsigned long long hud_logic_base;
+
+u16 hud_glyph(char c) {
+    if (c >= '0' && c <= '9') return HUD_FONT_DIGITS[c - '0'];
+    switch (c) {
+        case 'F': return HUD_GLYPH_F;
+        case 'W': return HUD_GLYPH_W;
+        case 'L': return HUD_GLYPH_L;
+        case 'D': return HUD_GLYPH_D;
+    }
+    return 0;
+}
+
+void hud_draw_char(int i, char c) {
+    u16 glyph = hud_glyph(c);
+    u16 cell[4 * 5];
+    for (int row = 0; row < 5; row++) {         // bottom row first, as the window fills
+        for (int col = 0; col < 4; col++) {
+            int bit = col < 3 && (glyph >> ((row * 3) + (2 - col))) & 1;
+            cell[row * 4 + col] = bit ? HUD_COLOR : FRAME_COLOR;
+        }
+    }
+    lcd_setWindow(HUD_X + i * 4, 4, HUD_Y, 5);
+    lcd_writePixels(cell, 4 * 5);
+}
+
+void hud_format(u32 frame_us, u32 writes, u32 logic_us, u32 dropped) {
+    if (frame_us > 999999) frame_us = 999999;
+    if (writes > 999999) writes = 999999;
+    if (logic_us > 99999) logic_us = 99999;
+    if (dropped > 999) dropped = 999;
+#if LCD_BUS_STATS
+    sprintf(hud_text, "F%6u W%6u L%5u D%3u", (unsigned)frame_us, (unsigned)writes,
+            (unsigned)logic_us, (unsigned)dropped);
+#else
+    (void)writes;           // not counted: the W field stays blank
+    sprintf(hud_text, "F%6u %7s L%5u D%3u", (unsigned)frame_us, "",
+            (unsigned)logic_us, (unsigned)dropped);
+#endif
+}
+
+// Brings the bezel in line with hud_text, one glyph per changed character
+void hud_draw(void) {
+    for (int i = 0; i < HUD_CHARS; i++) {
+        if (!hud_on_screen || hud_drawn[i] != hud_text[i]) {
+            hud_draw_char(i, hud_text[i]);
+            hud_drawn[i] = hud_text[i];
+        }
+    }
+    hud_on_screen = 1;
+}
+
+void hud_toggle(void) {
+    hud_shown = !hud_shown;
+    if (hud_shown) {
+        hud_draw();
+    } else {
+        lcd_fillRectangle(FRAME_COLOR, HUD_X, HUD_CHARS * 4, HUD_Y, 5);
+        hud_on_screen = 0;
+    }
+}
+
+// Once per main-loop pass. Averages the counters over HUD_PERIOD_MS, then
+// redraws whatever changed (nothing at all between periods).
+void hud_frame(void) {
+    u32 now = prof_now();
+    hud_frames++;
+    hud_cycles += now - hud_last_stamp;
+    hud_last_stamp = now;
+    
+    if (hud_cycles >= (u32)HUD_PERIOD_MS * PROF_HCLK_MHZ * 1000) {
+        // match finding plus gravity: the two zones never nest
+        unsigned long long logic = prof_table[ZONE_MATCHES].total + prof_table[ZONE_GRAVITY].total;
+        u32 writes = 0;
+#if LCD_BUS_STATS
+        writes = (lcd_bus_writes - hud_bus_base) / hud_frames;
+        hud_bus_base = lcd_bus_writes;
+#endif
+        hud_format(hud_cycles / PROF_HCLK_MHZ / hud_frames, writes,
+                   (u32)((logic - hud_logic_base) / PROF_HCLK_MHZ / hud_frames),
+                   ps2_dropped);
+        hud_frames = 0;
+        hud_cycles = 0;
+        hud_logic_base = logic;
+    }
+    if (hud_shown) hud_draw();
 }
 
 // ==========================================
@@ -401,197 +961,320 @@ void draw_gameover_screen(void) {
 // ==========================================
 
 void swap_tiles(int x1, int y1, int x2, int y2) {
-    int temp_type = grid[y1][x1][0];
-    int temp_color = grid[y1][x1][1];
-    grid[y1][x1][0] = grid[y2][x2][0];
-    grid[y1][x1][1] = grid[y2][x2][1];
-    grid[y2][x2][0] = temp_type;
-    grid[y2][x2][1] = temp_color;
+    TRACE_I(TR_SWAP, x1 | y1 << 4 | x2 << 8 | y2 << 12);
+    u8 temp = grid[y1][x1];
+    grid[y1][x1] = grid[y2][x2];
+    grid[y2][x2] = temp;
+    MARK_DIRTY(x1, y1);
+    MARK_DIRTY(x2, y2);
+}
+
+// ==========================================
+// MATCH BITBOARDS
+// ==========================================
+// One board per colour marking its NORMAL tiles, kept twice: by rows for the
+// horizontal test and transposed, by columns, for the vertical one. Each word
+// holds three lines of BB_STRIDE bits; bit 9 of a line is padding and never
+// set, so a shifted AND can't join the end of one line to the next.
+#define BB_STRIDE           10
+#define BB_LINES_PER_WORD   3
+#define BB_WORDS            3
+
+typedef struct {
+    u32 rows[BB_WORDS];     // line y, bit x
+    u32 cols[BB_WORDS];     // line x, bit y
+} Bitboard;
+
+#define BB_WORD(line)       ((line) / BB_LINES_PER_WORD)
+#define BB_BIT(line, pos)   (1u << (((line) % BB_LINES_PER_WORD) * BB_STRIDE + (pos)))
+#define BB_WORD_LINES(i)    (0x7u << ((i) * BB_LINES_PER_WORD))    // dirty mask bits of word i
+
+// Fills word i of every colour's rows (cols = 0) or cols board from grid[][]
+void bb_load_word(Bitboard colors[NUM_COLORS], int i, int cols) {
+    for (int line = i * BB_LINES_PER_WORD; line < (i + 1) * BB_LINES_PER_WORD; line++) {
+        for (int pos = 0; pos < GRID_SIZE; pos++) {
+            u8 cell = cols ? grid[pos][line] : grid[line][pos];
+            if (CELL_TYPE(cell) != NORMAL_TILE || cell == CELL_EMPTY) continue;
+            Bitboard *b = &colors[CELL_COLOR(cell)];
+            if (cols) b->cols[i] |= BB_BIT(line, pos);
+            else b->rows[i] |= BB_BIT(line, pos);
+        }
+    }
+}
+
+// First cells of the runs of exactly 4 and exactly 5 in the lines of n
+void bb_long_runs(u32 n, u32 *four, u32 *five) {
+    u32 first = n & ~(n << 1);
+    u32 r4 = n & (n >> 1) & (n >> 2) & (n >> 3);
+    *four = first & r4 & ~(n >> 4);
+    *five = first & r4 & (n >> 4) & ~(n >> 5);
+}
+
+// Every cell that is part of three in a line
+u32 bb_triples(u32 n) {
+    u32 r3 = n & (n >> 1) & (n >> 2);
+    return r3 | (r3 << 1) | (r3 << 2);
+}
+
+// Turns the cells set in word i of the rows (or cols) board into specials;
+// they stop counting as NORMAL for every test after this one
+void bb_place_special(Bitboard *color, int i, u32 cells, int cols, int type) {
+    for (int b = 0; cells; cells >>= 1, b++) {
+        if (!(cells & 1)) continue;
+        int line = i * BB_LINES_PER_WORD + b / BB_STRIDE;
+        int x = cols ? line : b % BB_STRIDE;
+        int y = cols ? b % BB_STRIDE : line;
+        SET_TILE_TYPE(x, y, type);
+        log_event(EV_SPECIAL, x, y, type);
+        color->rows[BB_WORD(y)] &= ~BB_BIT(y, x);
+        color->cols[BB_WORD(x)] &= ~BB_BIT(x, y);
+    }
 }
 
+// Clears the cells set in word i, counting those not cleared already
+int bb_clear(int i, u32 cells, int cols) {
+    int cleared = 0;
+    for (int b = 0; cells; cells >>= 1, b++) {
+        if (!(cells & 1)) continue;
+        int line = i * BB_LINES_PER_WORD + b / BB_STRIDE;
+        int x = cols ? line : b % BB_STRIDE;
+        int y = cols ? b % BB_STRIDE : line;
+        if (TILE_EMPTY(x, y)) continue;
+        log_event(EV_CLEAR, x, y, grid[y][x]);
+        CLEAR_TILE(x, y);
+        cleared++;
+    }
+    return cleared;
+}
+
+// Same rules as the nested scans it replaced: a run of 4 leaves a clearer on
+// its last cell (right / top), a run of 5 a bomb on its centre, and a fresh
+// special is no longer NORMAL, so it drops out of the three-in-a-row test
+// that follows. Rows go first; the columns see the row specials.
+// Only words holding a dirty line are loaded and tested: a clean line has no
+// run to find, and a special placed on it can only break runs, not make one.
 int find_and_clear_matches(void) {
-    int matches_found = 0;
-    int to_clear[GRID_SIZE][GRID_SIZE] = {0};
-    // --- Extended for special markers ---
-    // Horizontal
-    for (int y = 0; y < GRID_SIZE; y++) {
-        int run_len = 1;
-        for (int x = 1; x < GRID_SIZE; x++) {
-            if (grid[y][x][1] == grid[y][x-1][1] && grid[y][x][1] != -1 && 
-                    grid[y][x][0] == NORMAL_TILE && grid[y][x-1][0] == NORMAL_TILE) {
-                run_len++;
-            } else {
-                if (run_len == 4) {
-                    grid[y][x-1][0] = HORIZONTAL_CLEARER;
-                }
-                if (run_len == 5) {
-                    grid[y][x-3][0] = BOMB;
-                }
-                run_len = 1;
-            }
+    PROF_BEGIN(ZONE_MATCHES);
+    TRACE_B(TR_MATCHES, 0);
+    Bitboard colors[NUM_COLORS] = {{{0}}};
+    u32 clear_rows[BB_WORDS] = {0};
+    u32 clear_cols[BB_WORDS] = {0};
+    u32 rows = 0, cols = 0;     // words to test, bit i = word i
+    u32 four, five;
+    for (int i = 0; i < BB_WORDS; i++) {
+        if (dirty_rows & BB_WORD_LINES(i)) {
+            rows |= 1 << i;
+            bb_load_word(colors, i, 0);
         }
-        // Handle runs ending at edge
-        if (run_len == 4) grid[y][GRID_SIZE-1][0] = HORIZONTAL_CLEARER;
-        if (run_len == 5) grid[y][GRID_SIZE-3][0] = BOMB;
-        // Proceed with normal matching (matches of 3+)
-        for (int x = 0; x < GRID_SIZE - 2; x++) {
-            if (grid[y][x][0] == NORMAL_TILE && grid[y][x+1][0] == NORMAL_TILE && grid[y][x+2][0] == NORMAL_TILE &&
-                    grid[y][x][1] != -1 &&
-                    grid[y][x][1] == grid[y][x+1][1] &&
-                    grid[y][x][1] == grid[y][x+2][1]) {
-                to_clear[y][x] = 1; to_clear[y][x+1] = 1; to_clear[y][x+2] = 1; matches_found = 1;
-            }
+        if (dirty_cols & BB_WORD_LINES(i)) {
+            cols |= 1 << i;
+            bb_load_word(colors, i, 1);
         }
     }
-    // Vertical
-    for (int x = 0; x < GRID_SIZE; x++) {
-        int run_len = 1;
-        for (int y = 1; y < GRID_SIZE; y++) {
-            if (grid[y][x][1] == grid[y-1][x][1] && grid[y][x][1] != -1 &&
-                    grid[y][x][0] == NORMAL_TILE && grid[y-1][x][0] == NORMAL_TILE) {
-                run_len++;
-            } else {
-                if (run_len == 4) {
-                    grid[y-1][x][0] = VERTICAL_CLEARER;
-                }
-                if (run_len == 5) {
-                    grid[y-3][x][0] = BOMB;
-                }
-                run_len = 1;
-            }
+    for (int c = 0; c < NUM_COLORS; c++) {
+        for (int i = 0; i < BB_WORDS; i++) {
+            if (!(rows & 1 << i)) continue;
+            bb_long_runs(colors[c].rows[i], &four, &five);
+            bb_place_special(&colors[c], i, four << 3, 0, HORIZONTAL_CLEARER);
+            bb_place_special(&colors[c], i, five << 2, 0, BOMB);
+            clear_rows[i] |= bb_triples(colors[c].rows[i]);
         }
-        if (run_len == 4) grid[GRID_SIZE-1][x][0] = VERTICAL_CLEARER;
-        if (run_len == 5) grid[GRID_SIZE-3][x][0] = BOMB;
-        for (int y = 0; y < GRID_SIZE - 2; y++) {
-            if (grid[y][x][0] == NORMAL_TILE && grid[y+1][x][0] == NORMAL_TILE && grid[y+2][x][0] == NORMAL_TILE &&
-                    grid[y][x][1] != -1 &&
-                    grid[y][x][1] == grid[y+1][x][1] &&
-                    grid[y][x][1] == grid[y+2][x][1]) {
-                to_clear[y][x] = 1; to_clear[y+1][x] = 1; to_clear[y+2][x] = 1; matches_found = 1;
-            }
+    }
+    for (int c = 0; c < NUM_COLORS; c++) {
+        for (int i = 0; i < BB_WORDS; i++) {
+            if (!(cols & 1 << i)) continue;
+            bb_long_runs(colors[c].cols[i], &four, &five);
+            bb_place_special(&colors[c], i, four << 3, 1, VERTICAL_CLEARER);
+            bb_place_special(&colors[c], i, five << 2, 1, BOMB);
+            clear_cols[i] |= bb_triples(colors[c].cols[i]);
         }
     }
     int tiles_cleared = 0;
-    for (int y = 0; y < GRID_SIZE; y++) {
-        for (int x = 0; x < GRID_SIZE; x++) {
-            if (to_clear[y][x]) {
-                grid[y][x][1] = -1;
-                grid[y][x][0] = NORMAL_TILE;
-                tiles_cleared++;
-            }
-        }
+    for (int i = 0; i < BB_WORDS; i++) {
+        tiles_cleared += bb_clear(i, clear_rows[i], 0);
+        tiles_cleared += bb_clear(i, clear_cols[i], 1);
+    }
+    if (tiles_cleared > 0) {
+        score += tiles_cleared * 10;
+        log_event(EV_SCORE, 0, 0, tiles_cleared * 10);
     }
-    if (tiles_cleared > 0) score += tiles_cleared * 10;
-    return matches_found;
+    dirty_rows = dirty_cols = 0;    // cleared cells are dirtied again by the refill
+    TRACE_E(TR_MATCHES, tiles_cleared > 0);
+    PROF_END(ZONE_MATCHES);
+    return tiles_cleared > 0;
 }
 
-void apply_gravity(void) {
-    int moved;
-    do {
-        moved = 0;
-        for (int x = 0; x < GRID_SIZE; x++) {
-            for (int y = 0; y < GRID_SIZE - 1; y++) {
-                if (grid[y][x][1] == -1 && grid[y+1][x][1] != -1) {
-                    grid[y][x][0] = grid[y+1][x][0];
-                    grid[y][x][1] = grid[y+1][x][1];
-                    grid[y+1][x][0] = NORMAL_TILE;
-                    grid[y+1][x][1] = -1;
-                    moved = 1;
-                }
-            }
-            if (grid[GRID_SIZE - 1][x][1] == -1) {
-                grid[GRID_SIZE - 1][x][0] = NORMAL_TILE;
-                grid[GRID_SIZE - 1][x][1] = rand() % NUM_COLORS;
-                moved = 1;
+// O(1) test for a swap on a clean board (no dirty lines): any run it makes
+// passes through one of the two cells. Exact for find_and_clear_matches,
+// which then has something to do exactly when this returns 1.
+int swap_makes_match(int x1, int y1, int x2, int y2) {
+    u8 a = grid[y1][x1];
+    u8 b = grid[y2][x2];
+    grid[y1][x1] = b;
+    grid[y2][x2] = a;
+    int hit = cell_in_line(x1, y1) || cell_in_line(x2, y2);
+    grid[y1][x1] = a;
+    grid[y2][x2] = b;
+    return hit;
+}
+
+// Compacts every column in one pass and spawns the refills, recording in
+// fall[][] how far each final tile fell and logging the moves, spawns and
+// an EV_SETTLE. Refills draw rand() in the order the one-row-per-pass loop
+// did (pass by pass, columns left to right, lowest first), so a seed still
+// deals the same tiles. Returns the longest fall, 0 when nothing moved.
+int gravity_collapse(u8 fall[GRID_SIZE][GRID_SIZE]) {
+    PROF_BEGIN(ZONE_GRAVITY);
+    TRACE_B(TR_GRAVITY, 0);
+    int holes[GRID_SIZE];
+    int longest = 0;
+    for (int x = 0; x < GRID_SIZE; x++) {
+        int dst = 0;
+        for (int y = 0; y < GRID_SIZE; y++) {
+            if (TILE_EMPTY(x, y)) continue;
+            fall[dst][x] = y - dst;
+            if (y != dst) {
+                grid[dst][x] = grid[y][x];
+                MARK_DIRTY(x, dst);
+                log_event(EV_MOVE, x, dst, grid[dst][x] | (y - dst) << 8);
             }
+            dst++;
         }
-        if (moved) {
-            draw_grid_stable();
-            Delay(60000); 
+        holes[x] = GRID_SIZE - dst;
+        for (int y = dst; y < GRID_SIZE; y++) fall[y][x] = holes[x];
+        if (holes[x] > longest) longest = holes[x];
+    }
+    for (int pass = 0; pass < longest; pass++) {
+        for (int x = 0; x < GRID_SIZE; x++) {
+            if (pass < holes[x]) {
+                int y = GRID_SIZE - holes[x] + pass;
+                SET_TILE(x, y, NORMAL_TILE, rand() % NUM_COLORS);
+                log_event(EV_SPAWN, x, y, grid[y][x] | holes[x] << 8);
+            }
         }
-    } while (moved);
+    }
+    log_event(EV_SETTLE, 0, 0, longest);
+    TRACE_E(TR_GRAVITY, longest);
+    PROF_END(ZONE_GRAVITY);
+    return longest;
+}
+
+// Clear row/column/3x3 area - what the clearers and the bomb do
+void clear_cell(int x, int y) {
+    if (TILE_EMPTY(x, y)) return;
+    log_event(EV_CLEAR, x, y, grid[y][x]);
+    CLEAR_TILE(x, y);
 }
 
-// Clear row/column/3x3 area - helpers for clearers and bomb
 void clear_row(int row) {
-    for (int x = 0; x < GRID_SIZE; x++) {
-        grid[row][x][1] = -1; // clear each cell
-        grid[row][x][0] = NORMAL_TILE;
-    }
-    draw_grid_stable();
+    for (int x = 0; x < GRID_SIZE; x++) clear_cell(x, row);
 }
 
 void clear_column(int col) {
-    for (int y = 0; y < GRID_SIZE; y++) {
-        grid[y][col][1] = -1;
-        grid[y][col][0] = NORMAL_TILE;
-    }
-    draw_grid_stable();
+    for (int y = 0; y < GRID_SIZE; y++) clear_cell(col, y);
 }
 
 void clear_3x3_area(int cx, int cy) {
     for (int y = cy - 1; y <= cy + 1; y++) {
         for (int x = cx - 1; x <= cx + 1; x++) {
-            if (x >= 0 && x < GRID_SIZE && y >= 0 && y < GRID_SIZE) {
-                grid[y][x][1] = -1;
-                grid[y][x][0] = NORMAL_TILE;
-            }
+            if (x >= 0 && x < GRID_SIZE && y >= 0 && y < GRID_SIZE) clear_cell(x, y);
         }
     }
-    draw_grid_stable();
+}
+
+// ==========================================
+// CASCADE RESOLVER
+// ==========================================
+// Runs a whole move to a stable board without drawing anything; the caller
+// brackets it with event_begin() and play_events().
+
+// Gravity, then matches and gravity again until nothing more clears
+void resolve_cascade(void) {
+    u8 fall[GRID_SIZE][GRID_SIZE];
+    do {
+        gravity_collapse(fall);
+    } while (find_and_clear_matches());
+}
+
+// Swaps the two tiles and resolves the cascade, or swaps them back if
+// nothing matched. Returns 1 on a match.
+int resolve_swap(int x1, int y1, int x2, int y2) {
+    u16 rows = dirty_rows, cols = dirty_cols;
+    swap_tiles(x1, y1, x2, y2);
+    log_event(EV_SWAP, x1, y1, EVENT_POS(x2, y2));
+    if (!find_and_clear_matches()) {
+        swap_tiles(x1, y1, x2, y2);
+        log_event(EV_SWAP, x1, y1, EVENT_POS(x2, y2));
+        dirty_rows = rows;      // the board is back as it was, so is its state
+        dirty_cols = cols;
+        return 0;
+    }
+    resolve_cascade();
+    return 1;
+}
+
+// Fires the special at (x, y) and resolves the cascade after it
+void resolve_special(int x, int y) {
+    int type = TILE_TYPE(x, y);
+    log_event(EV_BLAST, x, y, type);
+    if (type == HORIZONTAL_CLEARER) clear_row(y);
+    else if (type == VERTICAL_CLEARER) clear_column(x);
+    else clear_3x3_area(x, y);
+    resolve_cascade();
 }
 
 void handle_keyboard_input(void) {
     static u32 last_key = 0;
     static u32 key_repeat = 0;
+    PROF_BEGIN(ZONE_INPUT);
+    u32 key, key_stamp;
+#ifndef HOST_BUILD
+    u32 primask = __get_PRIMASK();
+    __disable_irq();    // code and stamp from the same EXTI15_10 completion
+#endif
+    key = ps2key;
+    key_stamp = ps2key_stamp;
+#ifndef HOST_BUILD
+    __set_PRIMASK(primask);
+#endif
     
-    if (ps2key != 0 && key_debounce == 0) {
-        if (ps2key != last_key || key_repeat == 0) {
+    if (key != 0 && key_debounce == 0) {
+        if (key != last_key || key_repeat == 0) {
             int key_handled = 0;
             int dx = 0, dy = 0;
             int action_taken = 0; 
+            int lat_action = -1;    // LAT_* to record once the action is on screen
             
-            switch (ps2key) {
+            switch (key) {
                 case PS2_NUM8: dy = 1;  key_handled = 1; break; 
                 case PS2_NUM2: dy = -1; key_handled = 1; break; 
                 case PS2_NUM4: dx = -1; key_handled = 1; break;
                 case PS2_NUM6: dx = 1;  key_handled = 1; break;
+                case PS2_NUM_MINUS: hud_toggle(); key_handled = 1; break;
+                case PS2_NUM_PLUS: trace_dump(TR_NAMES, TR_COUNT); key_handled = 1; break;
+                case PS2_NUM_STAR:
+                    prof_dump(ZONE_NAMES, ZONE_COUNT);
+                    lat_dump(LAT_NAMES, LAT_COUNT);
+                    key_handled = 1;
+                    break;
                 case PS2_NUM5: {
-									int tile_type = grid[cursor_y][cursor_x][0];
+									int tile_type = TILE_TYPE(cursor_x, cursor_y);
 									// If special tile, activate immediately, then refill and clear combo chains
-									if (tile_type == HORIZONTAL_CLEARER) {
-											BUZZER_ON; Delay(10000); BUZZER_OFF;
-											clear_row(cursor_y);
-											apply_gravity();
-											while (find_and_clear_matches()) apply_gravity();
-											draw_single_tile(cursor_x, cursor_y);
-											is_selected = 0;
-											key_handled = 1;
-											break;
-									}
-									if (tile_type == VERTICAL_CLEARER) {
+									if (tile_type != NORMAL_TILE) {
 											BUZZER_ON; Delay(10000); BUZZER_OFF;
-											clear_column(cursor_x);
-											apply_gravity();
-											while (find_and_clear_matches()) apply_gravity();
-											draw_single_tile(cursor_x, cursor_y);
-											is_selected = 0;
-											key_handled = 1;
-											break;
-									}
-									if (tile_type == BOMB) {
-											BUZZER_ON; Delay(10000); BUZZER_OFF;
-											clear_3x3_area(cursor_x, cursor_y);
-											apply_gravity();
-											while (find_and_clear_matches()) apply_gravity();
+											event_begin();
+											resolve_special(cursor_x, cursor_y);
+											play_events(1);
 											draw_single_tile(cursor_x, cursor_y);
 											is_selected = 0;
 											key_handled = 1;
+											lat_action = LAT_SPECIAL;
 											break;
 									}
 									// Normal selection logic for regular gems
 									is_selected = !is_selected;
 									key_handled = 1;
+									lat_action = LAT_SELECT;
 									draw_single_tile(cursor_x, cursor_y);
 									if (is_selected) { BUZZER_ON; Delay(10000); BUZZER_OFF; }
 									break;
@@ -615,28 +1298,28 @@ void handle_keyboard_input(void) {
                             // Only redraw the two affected tiles
                             draw_single_tile(old_x, old_y); // Remove cursor from old
                             draw_single_tile(cursor_x, cursor_y); // Add cursor to new
+                            lat_action = LAT_MOVE;
                         }
                     } else {
                         // Swapping requires updating the logic and drawing
                         int target_x = cursor_x + dx;
                         int target_y = cursor_y + dy;
-                        if (target_x >= 0 && target_x < GRID_SIZE && target_y >= 0 && target_y < GRID_SIZE) {
-                            swap_tiles(cursor_x, cursor_y, target_x, target_y);
-                            // Draw swap immediately (partial redraw of 2 tiles)
+                        if (target_x >= 0 && target_x < GRID_SIZE && target_y >= 0 && target_y < GRID_SIZE &&
+                                !dirty_rows && !dirty_cols &&
+                                !swap_makes_match(cursor_x, cursor_y, target_x, target_y)) {
+                            // Nothing would match: skip the swap, scan and swap back
+                            lat_action = LAT_SWAP_BACK;
+                            is_selected = 0;
                             draw_single_tile(cursor_x, cursor_y);
-                            draw_single_tile(target_x, target_y);
-                            Delay(50000);
-                            
-                            if (find_and_clear_matches()) {
-                                BUZZER_ON; Delay(30000); BUZZER_OFF;
-                                apply_gravity(); // Full redraws happen here
-                                while (find_and_clear_matches()) apply_gravity();
+                        } else if (target_x >= 0 && target_x < GRID_SIZE && target_y >= 0 && target_y < GRID_SIZE) {
+                            // Whole cascade in logic first, then drawn from the event log
+                            event_begin();
+                            if (resolve_swap(cursor_x, cursor_y, target_x, target_y)) {
+                                lat_action = LAT_SWAP;
                             } else {
-                                // Swap back
-                                swap_tiles(cursor_x, cursor_y, target_x, target_y);
-                                draw_single_tile(cursor_x, cursor_y);
-                                draw_single_tile(target_x, target_y);
+                                lat_action = LAT_SWAP_BACK;
                             }
+                            play_events(1);
                             is_selected = 0; 
                             draw_single_tile(cursor_x, cursor_y); // Update cursor color back to white
                             action_taken = 1;
@@ -644,20 +1327,25 @@ void handle_keyboard_input(void) {
                     }
                 }
                 
-                // If a full action (like swap) happened, UI updates inside apply_gravity
+                // If a full action (like swap) happened, UI updates inside play_events
                 // But if purely cursor move, we don't need to redraw everything.
                 if (action_taken) {
                     draw_ui_bar(); // Just update score/time
                 }
+                if (lat_action >= 0) {
+                    lcd_dma_wait();     // the last fill or strip is on the panel too
+                    lat_record(lat_action, key_stamp);
+                }
                 
                 key_debounce = 10; key_repeat = 5;
             }
-            last_key = ps2key;
+            last_key = key;
         } else {
             key_repeat--;
         }
         ps2key = 0;
     }
+    PROF_END(ZONE_INPUT);
 }
 
 // Shuffle function - add after other helper functions
@@ -667,12 +1355,11 @@ void shuffle_game_grid() {
             int tx = rand() % GRID_SIZE;
             int ty = rand() % GRID_SIZE;
             // Swap type and color
-            int tmp_type = grid[y][x][0];
-            int tmp_color = grid[y][x][1];
-            grid[y][x][0] = grid[ty][tx][0];
-            grid[y][x][1] = grid[ty][tx][1];
-            grid[ty][tx][0] = tmp_type;
-            grid[ty][tx][1] = tmp_color;
+            u8 tmp = grid[y][x];
+            grid[y][x] = grid[ty][tx];
+            grid[ty][tx] = tmp;
+            MARK_DIRTY(x, y);
+            MARK_DIRTY(tx, ty);
         }
     }
     draw_grid_stable();
@@ -686,6 +1373,8 @@ void shuffle_game_grid() {
 // ==========================================
 int main(void) {
     IERG3810_clocktree_init();
+    prof_init();
+    trace_init();
     IERG3810_KEY_Init();    
     IERG3810_LED_Init();
     IERG3810_Buzzer_Init();
@@ -693,15 +1382,18 @@ int main(void) {
     IERG3810_PS2key_ExtiInit();
     lcd_init();
     IERG3810_SYSTICK_Init10ms();
-    IERG3810_usart2_init(36, 9600);
+    IERG3810_usart2_dma_init(36, USART2_BAUD); // PCLK1 = 36 MHz; TX drained by DMA1 ch7
     
     DS0_off; DS1_off; BUZZER_OFF;
     
     int btn1_prev_state = 1; 
     int btnUp_prev_state = 1;
+    u8 dump_trace = 0;      // the trace dump has the USART2 ring
 
-    current_state = STATE_MENU;
+    set_state(STATE_MENU);
     draw_start_screen();
+    hud_format(0, 0, 0, 0);
+    hud_last_stamp = prof_now();
     
     while(1) {
 				// *** RANDOM SEEDING LOGIC ***
@@ -713,13 +1405,13 @@ int main(void) {
         // Key 1 Logic
         if (btn1_curr == 0 && btn1_prev_state == 1) { 
             if (current_state == STATE_MENU) {
-                current_state = STATE_INSTRUCTIONS;
+                set_state(STATE_INSTRUCTIONS);
                 draw_instructions_screen();
             } else if (current_state == STATE_INSTRUCTIONS) {
 								// Seed the RNG here!
                 srand(seed_counter);
 							
-                current_state = STATE_GAME;
+                set_state(STATE_GAME);
                 init_grid_no_matches();
                 draw_frame(); 
                 draw_grid_stable();
@@ -731,7 +1423,7 @@ int main(void) {
         // Key UP Logic
         if (btnUp_curr == 0 && btnUp_prev_state == 1) {
             if (current_state == STATE_GAMEOVER || current_state == STATE_GAME) {
-                current_state = STATE_MENU;
+                set_state(STATE_MENU);
                 draw_start_screen();
             }
              Delay(50000);
@@ -740,7 +1432,7 @@ int main(void) {
 
         if (current_state == STATE_GAME) {
             if (game_timer_seconds <= 0) {
-                current_state = STATE_GAMEOVER;
+                set_state(STATE_GAMEOVER);
                 draw_gameover_screen();
             } else {
                 handle_keyboard_input();
@@ -751,6 +1443,12 @@ int main(void) {
                 }
             }
         }
+        lcd_window_frame(); // latch this pass's window-cache savings into lcd_win_frame
+        // Telemetry dumps go out as the USART2 ring has room, one at a time so
+        // their lines never interleave
+        if (dump_trace) dump_trace = trace_poll();
+        else if (!prof_poll()) dump_trace = trace_poll();
+        hud_frame();
         Delay(10000);
     }
 }